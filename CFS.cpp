@@ -3,22 +3,23 @@
 #include <algorithm>
 #include <string>
 #include <queue>
+#include <cstdint>
 
 struct Process {
     std::string id;
-    int arrival_time;
-    int burst_time;
+    std::int64_t arrival_time;
+    std::int64_t burst_time;
     int priority;
-    int remaining_time;
-    int waiting_time;
-    int turnaround_time;
-    double vruntime = 0.0;
+    std::int64_t remaining_time;
+    std::int64_t waiting_time;
+    std::int64_t turnaround_time;
+    std::int64_t vruntime = 0;  // in tenths of a time unit
     bool finished = false;
 };
 
-void calculateMetrics(std::vector<Process>& processes, int total_time) {
+void calculateMetrics(std::vector<Process>& processes, std::int64_t total_time) {
     double avg_wait = 0, avg_turn = 0;
-    int total_burst_time = 0;
+    std::int64_t total_burst_time = 0;
     for (auto& p : processes) {
         p.waiting_time = p.turnaround_time - p.burst_time;
         avg_wait += p.waiting_time;
@@ -38,7 +39,7 @@ void calculateMetrics(std::vector<Process>& processes, int total_time) {
     std::cout << "CPU Utilization: " << cpu_util << "%\n";
 }
 
-void printGantt(const std::vector<std::pair<std::string, int>>& gantt) {
+void printGantt(const std::vector<std::pair<std::string, std::int64_t>>& gantt) {
     std::cout << "Gantt Chart: ";
     for (const auto& entry : gantt) {
         std::cout << entry.first << " (" << entry.second << ") ";
@@ -46,9 +47,13 @@ void printGantt(const std::vector<std::pair<std::string, int>>& gantt) {
     std::cout << "\n";
 }
 
+// A task of priority p has weight 10 / p, so each unit it runs adds p tenths
+// to its vruntime. Integer vruntimes make ties exact, and a tie goes to the
+// earlier arrival (processes is sorted by arrival), as in the simulator's CFS.
 struct CFSCompare {
     bool operator()(const Process* a, const Process* b) {
-        return a->vruntime > b->vruntime;
+        if (a->vruntime != b->vruntime) return a->vruntime > b->vruntime;
+        return a > b;
     }
 };
 
@@ -69,11 +74,10 @@ int main() {
     });
 
     std::priority_queue<Process*, std::vector<Process*>, CFSCompare> ready_queue;
-    std::vector<std::pair<std::string, int>> gantt;
-    int current_time = 0;
+    std::vector<std::pair<std::string, std::int64_t>> gantt;
+    std::int64_t current_time = 0;
     int completed_processes = 0;
     int process_idx = 0;
-    const int slice = 1;
 
     while (completed_processes < processes.size()) {
         while (process_idx < processes.size() && processes[process_idx].arrival_time <= current_time) {
@@ -85,23 +89,36 @@ int main() {
         }
 
         if (ready_queue.empty()) {
-            current_time++;
+            current_time = processes[process_idx].arrival_time;
             continue;
         }
 
         Process* current_process = ready_queue.top();
         ready_queue.pop();
 
-        current_time += slice;
-        current_process->remaining_time -= slice;
-        
-        double weight = 10.0 / current_process->priority;
-        current_process->vruntime += (double)slice / weight;
+        // The task keeps winning unit slices until its vruntime passes the
+        // next task's (or reaches it, if that one arrived first), it finishes,
+        // or something arrives, so that whole stretch runs at once.
+        std::int64_t time_to_run = current_process->remaining_time;
+        if (!ready_queue.empty()) {
+            const Process* next = ready_queue.top();
+            std::int64_t lead = next->vruntime - current_process->vruntime;
+            std::int64_t step = current_process->priority;
+            std::int64_t overtaken = current_process < next ? lead / step + 1 : (lead + step - 1) / step;
+            time_to_run = std::min(time_to_run, overtaken);
+        }
+        if (process_idx < processes.size()) {
+            time_to_run = std::min(time_to_run, processes[process_idx].arrival_time - current_time);
+        }
+
+        current_time += time_to_run;
+        current_process->remaining_time -= time_to_run;
+        current_process->vruntime += time_to_run * current_process->priority;
 
         if (gantt.empty() || gantt.back().first != current_process->id) {
-            gantt.push_back({current_process->id, slice});
+            gantt.push_back({current_process->id, time_to_run});
         } else {
-            gantt.back().second += slice;
+            gantt.back().second += time_to_run;
         }
 
         while (process_idx < processes.size() && processes[process_idx].arrival_time <= current_time) {
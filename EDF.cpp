@@ -3,22 +3,23 @@
 #include <algorithm>
 #include <string>
 #include <queue>
+#include <cstdint>
 
 struct Process {
     std::string id;
-    int arrival_time;
-    int burst_time;
+    std::int64_t arrival_time;
+    std::int64_t burst_time;
     int priority;
-    int remaining_time;
-    int waiting_time;
-    int turnaround_time;
-    int deadline;
+    std::int64_t remaining_time;
+    std::int64_t waiting_time;
+    std::int64_t turnaround_time;
+    std::int64_t deadline;
     bool finished = false;
 };
 
-void calculateMetrics(std::vector<Process>& processes, int total_time) {
+void calculateMetrics(std::vector<Process>& processes, std::int64_t total_time) {
     double avg_wait = 0, avg_turn = 0;
-    int total_burst_time = 0;
+    std::int64_t total_burst_time = 0;
     for (auto& p : processes) {
         p.waiting_time = p.turnaround_time - p.burst_time;
         avg_wait += p.waiting_time;
@@ -38,7 +39,7 @@ void calculateMetrics(std::vector<Process>& processes, int total_time) {
     std::cout << "CPU Utilization: " << cpu_util << "%\n";
 }
 
-void printGantt(const std::vector<std::pair<std::string, int>>& gantt) {
+void printGantt(const std::vector<std::pair<std::string, std::int64_t>>& gantt) {
     std::cout << "Gantt Chart: ";
     for (const auto& entry : gantt) {
         std::cout << entry.first << " (" << entry.second << ") ";
@@ -70,8 +71,8 @@ int main() {
     });
 
     std::priority_queue<Process*, std::vector<Process*>, EDFCompare> ready_queue;
-    std::vector<std::pair<std::string, int>> gantt;
-    int current_time = 0;
+    std::vector<std::pair<std::string, std::int64_t>> gantt;
+    std::int64_t current_time = 0;
     int completed_processes = 0;
     int process_idx = 0;
     Process* current_process = nullptr;
@@ -92,29 +93,32 @@ int main() {
             ready_queue.pop();
         }
 
-        if (current_process != nullptr) {
-            if (gantt.empty() || gantt.back().first != current_process->id) {
-                gantt.push_back({current_process->id, 1});
-            } else {
-                gantt.back().second++;
-            }
-
-            current_process->remaining_time--;
-            
-            if (current_process->remaining_time == 0) {
-                current_process->finished = true;
-                completed_processes++;
-                current_process->turnaround_time = (current_time + 1) - current_process->arrival_time;
-                current_process = nullptr;
-            }
+        if (current_process == nullptr) {
+            current_time = processes[process_idx].arrival_time;
+            continue;
         }
+
+        // Deadlines only change at arrivals, so the current job keeps the CPU until
+        // the next arrival or until it finishes.
+        std::int64_t time_to_run = current_process->remaining_time;
+        if (process_idx < processes.size()) {
+            time_to_run = std::min(time_to_run, processes[process_idx].arrival_time - current_time);
+        }
+
+        if (gantt.empty() || gantt.back().first != current_process->id) {
+            gantt.push_back({current_process->id, time_to_run});
+        } else {
+            gantt.back().second += time_to_run;
+        }
+
+        current_process->remaining_time -= time_to_run;
+        current_time += time_to_run;
         
-        current_time++;
-        
-        if (current_process == nullptr && ready_queue.empty() && completed_processes < processes.size() && process_idx < processes.size()) {
-            if(current_time < processes[process_idx].arrival_time){
-                 current_time = processes[process_idx].arrival_time;
-            }
+        if (current_process->remaining_time == 0) {
+            current_process->finished = true;
+            completed_processes++;
+            current_process->turnaround_time = current_time - current_process->arrival_time;
+            current_process = nullptr;
         }
     }
 
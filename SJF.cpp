@@ -2,6 +2,7 @@
 #include <vector>
 #include <algorithm>
 #include <string>
+#include <queue>
 
 
 struct Process {
@@ -41,6 +42,17 @@ void printGantt(const std::vector<std::pair<std::string, int>>& gantt) {
     std::cout << "\n";
 }
 
+// Orders ready indices so the shortest burst is on top, earlier arrivals first on ties.
+struct ShorterBurstFirst {
+    const std::vector<Process>* processes;
+    bool operator()(size_t a, size_t b) const {
+        const Process& pa = (*processes)[a];
+        const Process& pb = (*processes)[b];
+        if (pa.burst_time != pb.burst_time) return pa.burst_time > pb.burst_time;
+        return a > b;
+    }
+};
+
 int main() {
     std::vector<Process> processes = {
         {"P1", 0, 8, 2, 8, 0, 0},
@@ -55,44 +67,30 @@ int main() {
 
     std::vector<std::pair<std::string, int>> gantt;
     int current_time = 0;
-    std::vector<Process> ready_queue;
+    // The ready queue holds indices into `processes`; arrivals are taken from a
+    // cursor over the arrival-sorted vector, so nothing is copied or looked up.
+    std::priority_queue<size_t, std::vector<size_t>, ShorterBurstFirst> ready_queue(ShorterBurstFirst{&processes});
     int completed_processes = 0;
-    std::vector<bool> is_in_queue(processes.size(), false);
+    size_t next_arrival = 0;
 
     while (completed_processes < processes.size()) {
-        for (int i = 0; i < processes.size(); ++i) {
-            if (processes[i].arrival_time <= current_time && !is_in_queue[i]) {
-                ready_queue.push_back(processes[i]);
-                is_in_queue[i] = true;
-            }
+        while (next_arrival < processes.size() && processes[next_arrival].arrival_time <= current_time) {
+            ready_queue.push(next_arrival);
+            next_arrival++;
         }
         
         if (ready_queue.empty()) {
-            for (int i = 0; i < processes.size(); ++i) {
-                if (!is_in_queue[i]) {
-                    current_time = processes[i].arrival_time;
-                    break;
-                }
-            }
+            current_time = processes[next_arrival].arrival_time;
             continue;
         }
 
-        std::sort(ready_queue.begin(), ready_queue.end(), [](const Process& a, const Process& b) {
-            return a.burst_time < b.burst_time;
-        });
+        Process& p = processes[ready_queue.top()];
+        ready_queue.pop();
 
-        Process current_process = ready_queue.front();
-        ready_queue.erase(ready_queue.begin());
-
-        for (auto& p : processes) {
-            if (p.id == current_process.id) {
-                p.waiting_time = current_time - p.arrival_time;
-                current_time += p.burst_time;
-                p.turnaround_time = current_time - p.arrival_time;
-                gantt.push_back({p.id, p.burst_time});
-                break;
-            }
-        }
+        p.waiting_time = current_time - p.arrival_time;
+        current_time += p.burst_time;
+        p.turnaround_time = current_time - p.arrival_time;
+        gantt.push_back({p.id, p.burst_time});
         
         completed_processes++;
     }
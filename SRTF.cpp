@@ -3,19 +3,21 @@
 #include <vector>
 #include <algorithm>
 #include <string>
+#include <numeric>
+#include <cstdint>
 
 struct Process {
     std::string id;
-    int arrival_time;
-    int burst_time;
+    std::int64_t arrival_time;
+    std::int64_t burst_time;
     int priority; 
-    int remaining_time;
-    int waiting_time;
-    int turnaround_time;
+    std::int64_t remaining_time;
+    std::int64_t waiting_time;
+    std::int64_t turnaround_time;
     bool finished = false; 
 };
 
-void calculateMetrics(std::vector<Process>& processes, int total_time) {
+void calculateMetrics(std::vector<Process>& processes, std::int64_t total_time) {
     double avg_wait = 0, avg_turn = 0;
     for (auto& p : processes) {
         
@@ -29,7 +31,7 @@ void calculateMetrics(std::vector<Process>& processes, int total_time) {
         avg_turn /= processes.size();
     }
 
-    int total_burst_time = 0;
+    std::int64_t total_burst_time = 0;
     for(const auto& p : processes) {
         total_burst_time += p.burst_time;
     }
@@ -40,19 +42,19 @@ void calculateMetrics(std::vector<Process>& processes, int total_time) {
     std::cout << "CPU Utilization: " << cpu_util << "%\n";
 }
 
-void printGantt(const std::vector<std::pair<std::string, int>>& gantt) {
+void printGantt(const std::vector<std::pair<std::string, std::int64_t>>& gantt) {
     std::cout << "Gantt Chart: ";
     std::string last_id = "";
-    int duration = 0;
+    std::int64_t duration = 0;
     for (const auto& entry : gantt) {
         if (entry.first == last_id) {
-            duration++;
+            duration += entry.second;
         } else {
             if (!last_id.empty()) {
                 std::cout << last_id << " (" << duration << ") ";
             }
             last_id = entry.first;
-            duration = 1;
+            duration = entry.second;
         }
     }
     if (!last_id.empty()) {
@@ -74,13 +76,25 @@ int main() {
         p.remaining_time = p.burst_time;
     }
 
-    std::vector<std::pair<std::string, int>> gantt;
-    int current_time = 0;
+    // Visit arrivals in time order so the next preemption point is always known.
+    std::vector<size_t> by_arrival(processes.size());
+    std::iota(by_arrival.begin(), by_arrival.end(), 0);
+    std::stable_sort(by_arrival.begin(), by_arrival.end(), [&](size_t a, size_t b) {
+        return processes[a].arrival_time < processes[b].arrival_time;
+    });
+
+    std::vector<std::pair<std::string, std::int64_t>> gantt;
+    std::int64_t current_time = 0;
     int completed_processes = 0;
+    size_t next_arrival = 0;
 
     while (completed_processes < processes.size()) {
+        while (next_arrival < by_arrival.size() && processes[by_arrival[next_arrival]].arrival_time <= current_time) {
+            next_arrival++;
+        }
+
         Process* shortest_process = nullptr;
-        int min_remaining_time = -1;
+        std::int64_t min_remaining_time = -1;
 
         for (auto& p : processes) {
             if (p.arrival_time <= current_time && !p.finished) {
@@ -93,14 +107,21 @@ int main() {
         
         
         if (shortest_process == nullptr) {
-            current_time++;
+            current_time = processes[by_arrival[next_arrival]].arrival_time;
             continue;
         }
 
-        gantt.push_back({shortest_process->id, 1});
+        // Nothing can preempt the shortest job before the next arrival, so run it
+        // straight to that arrival or to its completion, whichever comes first.
+        std::int64_t time_to_run = shortest_process->remaining_time;
+        if (next_arrival < by_arrival.size()) {
+            time_to_run = std::min(time_to_run, processes[by_arrival[next_arrival]].arrival_time - current_time);
+        }
+
+        gantt.push_back({shortest_process->id, time_to_run});
 
-        shortest_process->remaining_time--;
-        current_time++;
+        shortest_process->remaining_time -= time_to_run;
+        current_time += time_to_run;
 
         if (shortest_process->remaining_time == 0) {
             shortest_process->finished = true;
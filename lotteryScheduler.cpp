@@ -4,6 +4,8 @@
 #include <string>
 #include <random>
 #include <numeric>
+#include <map>
+#include <sstream>
 
 struct Process {
     std::string id;
@@ -46,61 +48,197 @@ void printGantt(const std::vector<std::pair<std::string, int>>& gantt) {
     std::cout << "\n";
 }
 
-int main() {
+int findProcess(const std::vector<Process>& processes, const std::string& id) {
+    for (int i = 0; i < processes.size(); ++i) {
+        if (processes[i].id == id) return i;
+    }
+    return -1;
+}
+
+int baseTickets(const Process& p) {
+    return std::max(1, 10 / p.priority);
+}
+
+// Fenwick tree over per-process ticket counts: updating one holder and drawing
+// the holder of a given ticket both cost O(log n).
+class TicketTree {
+public:
+    explicit TicketTree(int n) : tree(n + 1, 0), count(n, 0) {}
+
+    long long total() const { return sum; }
+    long long tickets(int i) const { return count[i]; }
+
+    void set(int i, long long tickets) {
+        long long delta = tickets - count[i];
+        count[i] = tickets;
+        sum += delta;
+        for (int k = i + 1; k < tree.size(); k += k & -k) {
+            tree[k] += delta;
+        }
+    }
+
+    // Index of the holder of `ticket`, for 0 <= ticket < total().
+    int find(long long ticket) const {
+        int pos = 0;
+        int step = 1;
+        while (step * 2 < tree.size()) step *= 2;
+        for (; step > 0; step /= 2) {
+            if (pos + step < tree.size() && tree[pos + step] <= ticket) {
+                pos += step;
+                ticket -= tree[pos];
+            }
+        }
+        return pos;
+    }
+
+private:
+    std::vector<long long> tree;
+    std::vector<long long> count;
+    long long sum = 0;
+};
+
+int main(int argc, char* argv[]) {
+    std::map<std::string, std::string> args;
+    for (int i = 1; i < argc; i += 2) {
+        args[argv[i]] = (i + 1 < argc) ? argv[i + 1] : "";
+    }
+    // --quantum 0 (the default) runs each winner to completion as before. With a
+    // positive quantum a new draw happens every quantum and at each arrival.
+    int quantum = args.count("--quantum") ? std::stoi(args["--quantum"]) : 0;
+    // --transfer P3:P2 makes P3 wait for P2 to finish, lending P2 its tickets meanwhile.
+    std::string transfers = args["--transfer"];
+
     std::vector<Process> processes = {
         {"P1", 0, 8, 2, 0, 0, 0},
         {"P2", 1, 4, 1, 0, 0, 0},
         {"P3", 2, 9, 3, 0, 0, 0},
         {"P4", 3, 5, 4, 0, 0, 0}
     };
+    std::stable_sort(processes.begin(), processes.end(), [](const Process& a, const Process& b) {
+        return a.arrival_time < b.arrival_time;
+    });
+    int n = processes.size();
+    for (auto& p : processes) {
+        p.remaining_time = p.burst_time;
+    }
+
+    std::mt19937_64 gen;
+    if (args.count("--seed")) {
+        gen.seed(std::stoull(args["--seed"]));
+    } else {
+        std::random_device rd;
+        gen.seed(rd());
+    }
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::vector<int> waits_on(n, -1);
+    std::istringstream transfer_list(transfers);
+    std::string entry;
+    while (std::getline(transfer_list, entry, ',')) {
+        size_t colon = entry.find(':');
+        int from = (colon == std::string::npos) ? -1 : findProcess(processes, entry.substr(0, colon));
+        int to = (colon == std::string::npos) ? -1 : findProcess(processes, entry.substr(colon + 1));
+        if (from == -1 || to == -1 || from == to) {
+            std::cerr << "Invalid --transfer entry: " << entry << "\n";
+            return 1;
+        }
+        waits_on[from] = to;
+    }
+    for (int i = 0; i < n; ++i) {
+        if (waits_on[i] != -1 && waits_on[waits_on[i]] != -1) {
+            std::cerr << "Chained --transfer entries are not supported: " << processes[i].id << "\n";
+            return 1;
+        }
+    }
+
+    // A holder's tree entry is its own (possibly compensated) tickets plus the
+    // tickets lent to it by waiting processes, and is only non-zero while the
+    // holder has arrived and is runnable.
+    TicketTree tickets(n);
+    std::vector<long long> own(n, 0);
+    std::vector<long long> lent(n, 0);
+    std::vector<bool> runnable(n, false);
+    std::vector<std::vector<int>> waiters(n);
+    auto refresh = [&](int i) {
+        tickets.set(i, runnable[i] ? own[i] + lent[i] : 0);
+    };
+    auto arrive = [&](int i) {
+        own[i] = baseTickets(processes[i]);
+        int to = waits_on[i];
+        if (to != -1 && !processes[to].finished) {
+            waiters[to].push_back(i);
+            lent[to] += own[i];
+            refresh(to);
+        } else {
+            runnable[i] = true;
+            refresh(i);
+        }
+    };
+    auto finish = [&](int i) {
+        runnable[i] = false;
+        lent[i] = 0;
+        refresh(i);
+        for (int j : waiters[i]) {
+            runnable[j] = true;
+            refresh(j);
+        }
+        waiters[i].clear();
+    };
 
     std::vector<std::pair<std::string, int>> gantt;
     int current_time = 0;
     int completed_processes = 0;
+    int next_arrival = 0;
     
-    while (completed_processes < processes.size()) {
-        std::vector<Process*> ready_queue;
-        int total_tickets = 0;
-
-        for (auto& p : processes) {
-            if (!p.finished && p.arrival_time <= current_time) {
-                ready_queue.push_back(&p);
-                total_tickets += (10 / p.priority);
-            }
+    while (completed_processes < n) {
+        while (next_arrival < n && processes[next_arrival].arrival_time <= current_time) {
+            arrive(next_arrival++);
         }
 
-        if (ready_queue.empty()) {
-            current_time++;
+        if (tickets.total() == 0) {
+            current_time = processes[next_arrival].arrival_time;
             continue;
         }
 
-        std::uniform_int_distribution<> distrib(1, total_tickets);
-        int winning_ticket = distrib(gen);
+        std::uniform_int_distribution<long long> distrib(0, tickets.total() - 1);
+        int w = tickets.find(distrib(gen));
+        Process* winner = &processes[w];
 
-        Process* winner = nullptr;
-        int ticket_sum = 0;
-        for (auto* p : ready_queue) {
-            ticket_sum += (10 / p->priority);
-            if (winning_ticket <= ticket_sum) {
-                winner = p;
-                break;
+        // Compensation tickets only last until the holder wins again.
+        if (own[w] != baseTickets(*winner)) {
+            own[w] = baseTickets(*winner);
+            refresh(w);
+        }
+
+        int time_to_run = winner->remaining_time;
+        if (quantum > 0) {
+            time_to_run = std::min(time_to_run, quantum);
+            if (next_arrival < n) {
+                time_to_run = std::min(time_to_run, processes[next_arrival].arrival_time - current_time);
             }
         }
 
-        if (winner) {
-            int time_to_run = winner->burst_time;
+        if (gantt.empty() || gantt.back().first != winner->id) {
             gantt.push_back({winner->id, time_to_run});
-            current_time += time_to_run;
+        } else {
+            gantt.back().second += time_to_run;
+        }
+        current_time += time_to_run;
+        winner->remaining_time -= time_to_run;
+
+        if (winner->remaining_time == 0) {
             winner->finished = true;
             winner->turnaround_time = current_time - winner->arrival_time;
             completed_processes++;
+            finish(w);
+        } else if (time_to_run < quantum) {
+            // Cut short by an arrival: inflate the holder's tickets by
+            // quantum / used so its share of the CPU stays proportional.
+            own[w] = baseTickets(*winner) * quantum / time_to_run;
+            refresh(w);
         }
     }
 
     calculateMetrics(processes, current_time);
     printGantt(gantt);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,273 @@
+// Times every scheduler's schedule() over generated workloads of growing size
+// and prints one CSV row per (scheduler, workload, size). With
+// --check-allocations N it instead fails if any steady-state run up to N
+// processes allocates.
+#define SIMULATOR_NO_MAIN
+#include "taskScheduling.cpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+
+// Every allocation in the process is counted, so a run's count is the
+// difference across its schedule() call. Runs draw from a RunArena reset
+// before each one, after an untimed warm-up run has sized it, so the count is
+// the steady-state one and should be zero.
+static std::atomic<std::uint64_t> allocation_count{0};
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+// GCC pairs the replaced new with free() once these are inlined and warns.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
+
+// Peak RSS in kB since the last resetPeakRss(). Linux resets the high-water
+// mark through clear_refs; elsewhere this is the peak for the whole process.
+void resetPeakRss() {
+    std::ofstream clear("/proc/self/clear_refs");
+    if (clear) clear << "5";
+}
+
+long peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return std::stol(line.substr(6));
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Workload shapes. All of them keep offered load near one, so ready sets grow
+// and shrink instead of staying empty or growing without bound.
+//   uniform:     arrivals spread evenly, bursts 1-10
+//   bursty:      clumps of 64 arrivals at once, separated by idle gaps
+//   heavy-tail:  Poisson arrivals, Pareto(1.5) bursts capped at 10^6
+std::vector<Process> generateWorkload(const std::string& shape, size_t n, std::uint64_t seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<SimTime> burst(1, 10);
+    std::uniform_int_distribution<int> priority(1, 5);
+    std::vector<Process> processes;
+    processes.reserve(n);
+
+    if (shape == "uniform") {
+        std::uniform_int_distribution<SimTime> arrival(0, (SimTime)n * 11 / 2);
+        for (size_t i = 0; i < n; ++i) {
+            processes.push_back({(std::uint32_t)i, arrival(gen), burst(gen), priority(gen)});
+        }
+    } else if (shape == "bursty") {
+        const size_t clump = 64;
+        std::uniform_int_distribution<SimTime> jitter(0, 3);
+        SimTime t = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (i % clump == 0) t += clump * 11 / 2;
+            processes.push_back({(std::uint32_t)i, t + jitter(gen), burst(gen), priority(gen)});
+        }
+    } else if (shape == "heavy-tail") {
+        const double alpha = 1.5;
+        std::exponential_distribution<double> gap(1.0 / 3.0);  // mean gap 3, the mean of Pareto(1.5)
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        double t = 0;
+        for (size_t i = 0; i < n; ++i) {
+            t += gap(gen);
+            double b = std::min(1e6, std::ceil(1.0 / std::pow(1.0 - u(gen), 1.0 / alpha)));
+            processes.push_back({(std::uint32_t)i, (SimTime)t, (SimTime)b, priority(gen)});
+        }
+    }
+    std::stable_sort(processes.begin(), processes.end(), [](const Process& a, const Process& b) {
+        return a.arrival_time < b.arrival_time;
+    });
+    return processes;
+}
+
+// `virtual_feed` drives the policy through run(ProcessFeed&), so every feed
+// call is dispatched at run time, instead of schedule()'s statically bound one.
+// Decision latency of the online schedulers with `ready` jobs queued: each
+// step asks for the next decision, advances to its end and resubmits the jobs
+// that finished, so the ready set stays the same size. Prints one CSV row per
+// policy with percentiles of the step time.
+void benchOnline(size_t ready, size_t steps, const std::vector<std::string>& only) {
+    std::cout << "scheduler,ready,decisions,p50_ns,p99_ns,p999_ns,max_ns\n";
+    for (const std::string type : {"fcfs", "sjf", "srtf", "priority", "rr", "edf"}) {
+        if (!only.empty() && std::find(only.begin(), only.end(), type) == only.end()) continue;
+        SchedulerOptions options;
+        std::unique_ptr<OnlineScheduler> scheduler = makeOnlineScheduler(type, options);
+        std::mt19937_64 gen(ready);
+        std::uniform_int_distribution<SimTime> burst(1, 10);
+        std::uniform_int_distribution<int> priority(1, 5);
+        auto submit = [&](std::uint32_t pid) {
+            Process job{pid, scheduler->now(), burst(gen), priority(gen)};
+            job.deadline = job.arrival_time + job.burst_time * (1 + priority(gen));
+            scheduler->submit(job);
+        };
+        for (size_t i = 0; i < ready; ++i) submit(i);
+
+        LatencyHistogram step_ns;
+        std::vector<std::uint32_t> finished;
+        for (size_t i = 0; i < steps; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            Decision decision = scheduler->nextDecision();
+            scheduler->advanceTo(decision.until);
+            scheduler->takeFinished(finished);
+            for (std::uint32_t pid : finished) submit(pid);
+            auto stop = std::chrono::steady_clock::now();
+            step_ns.record(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        }
+        std::cout << type << "," << ready << "," << steps << "," << step_ns.percentile(0.5) << ","
+                  << step_ns.percentile(0.99) << "," << step_ns.percentile(0.999) << "," << step_ns.max() << "\n"
+                  << std::flush;
+    }
+}
+
+struct BenchCase {
+    std::string name;
+    std::string type;
+    ReadySelect select;
+    bool virtual_feed = false;
+};
+
+const std::vector<BenchCase> BENCH_CASES = {
+    {"fcfs", "fcfs", ReadySelect::Heap},
+    {"sjf", "sjf", ReadySelect::Heap},
+    {"sjf-scan", "sjf", ReadySelect::Scan},
+    {"srtf", "srtf", ReadySelect::Heap},
+    {"srtf-scan", "srtf", ReadySelect::Scan},
+    {"priority", "priority", ReadySelect::Heap},
+    {"priority-scan", "priority", ReadySelect::Scan},
+    {"rr", "rr", ReadySelect::Heap},
+    {"cfs", "cfs", ReadySelect::Heap},
+    {"mlq", "mlq", ReadySelect::Heap},
+    {"mlfq", "mlfq", ReadySelect::Heap},
+    {"lottery", "lottery", ReadySelect::Heap},
+    {"edf", "edf", ReadySelect::Heap},
+    {"fcfs-virtual", "fcfs", ReadySelect::Heap, true},
+    {"sjf-virtual", "sjf", ReadySelect::Heap, true},
+    {"srtf-virtual", "srtf", ReadySelect::Heap, true},
+    {"priority-virtual", "priority", ReadySelect::Heap, true},
+    {"rr-virtual", "rr", ReadySelect::Heap, true},
+    {"edf-virtual", "edf", ReadySelect::Heap, true},
+};
+
+// One run of `bench` over `scratch`, drawing from `memory`.
+void runCase(const BenchCase& bench, Scheduler& scheduler, std::vector<Process>& scratch, Gantt& gantt,
+             std::pmr::memory_resource* memory) {
+    SimTime total_time = 0;
+    if (!bench.virtual_feed) {
+        scheduler.schedule(scratch, gantt, total_time, memory);
+        return;
+    }
+    VectorFeed feed(scratch, memory);
+    scheduler.run(static_cast<ProcessFeed&>(feed), gantt, total_time);
+}
+
+// Runs every case on every shape at sizes 10 to `max_n`, each once to warm a
+// RunArena and once more from the reset arena, and reports the runs whose
+// second pass allocated. Returns the process exit status.
+int checkAllocations(size_t max_n, const std::vector<std::string>& shapes) {
+    int failures = 0;
+    for (const auto& shape : shapes) {
+        for (size_t n = 10; n <= max_n; n *= 10) {
+            const std::vector<Process> workload = generateWorkload(shape, n, n);
+            std::vector<Process> scratch;
+            Gantt gantt;
+            RunArena arena;
+            for (const auto& bench : BENCH_CASES) {
+                SchedulerOptions options;
+                options.select = bench.select;
+                std::unique_ptr<Scheduler> scheduler = makeScheduler(bench.type, options);
+                std::uint64_t allocations = 0;
+                for (int pass = 0; pass < 2; ++pass) {
+                    scratch = workload;
+                    gantt.clear();
+                    std::pmr::memory_resource* memory = arena.reset();
+                    std::uint64_t allocations_before = allocation_count.load(std::memory_order_relaxed);
+                    runCase(bench, *scheduler, scratch, gantt, memory);
+                    allocations = allocation_count.load(std::memory_order_relaxed) - allocations_before;
+                }
+                if (allocations != 0) {
+                    std::cerr << bench.name << " on " << n << " " << shape << " processes: " << allocations
+                              << " allocations on a warm arena\n";
+                    failures++;
+                }
+            }
+            if (max_n / 10 < n) break;
+        }
+    }
+    if (failures == 0) std::cout << "No steady-state allocations\n";
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    std::map<std::string, std::string> args;
+    for (int i = 1; i < argc; i += 2) {
+        args[argv[i]] = (i + 1 < argc) ? argv[i + 1] : "";
+    }
+    size_t min_n = args.count("--min-n") ? std::stoull(args["--min-n"]) : 10;
+    size_t max_n = args.count("--max-n") ? std::stoull(args["--max-n"]) : 10000000;
+    // Small sizes are repeated until this much time has been measured.
+    double min_time_ms = args.count("--min-time-ms") ? std::stod(args["--min-time-ms"]) : 200;
+    std::vector<std::string> shapes = args.count("--workloads") ? splitList(args["--workloads"])
+                                                                 : std::vector<std::string>{"uniform", "bursty", "heavy-tail"};
+    std::vector<std::string> only = splitList(args["--schedulers"]);
+    // --online-ready N measures the online API instead, over --online-steps decisions.
+    if (args.count("--online-ready")) {
+        size_t steps = args.count("--online-steps") ? std::stoull(args["--online-steps"]) : 200000;
+        benchOnline(std::stoull(args["--online-ready"]), steps, only);
+        return 0;
+    }
+    if (args.count("--check-allocations")) return checkAllocations(std::stoull(args["--check-allocations"]), shapes);
+
+    std::cout << "scheduler,workload,n,runs,decisions,ns_per_decision,peak_rss_kb,allocs_per_run\n";
+    for (const auto& shape : shapes) {
+        for (size_t n = min_n; n <= max_n; n *= 10) {
+            const std::vector<Process> workload = generateWorkload(shape, n, n);
+            std::vector<Process> scratch;
+            Gantt gantt;
+            RunArena arena;
+            for (const auto& bench : BENCH_CASES) {
+                if (!only.empty() && std::find(only.begin(), only.end(), bench.name) == only.end()) continue;
+                SchedulerOptions options;
+                options.select = bench.select;
+                std::unique_ptr<Scheduler> scheduler = makeScheduler(bench.type, options);
+
+                size_t runs = 0;
+                size_t decisions = 0;
+                double elapsed_ns = 0;
+                std::uint64_t allocations = 0;
+                resetPeakRss();
+                scratch = workload;
+                gantt.clear();
+                runCase(bench, *scheduler, scratch, gantt, arena.reset());
+                do {
+                    scratch = workload;
+                    gantt.clear();
+                    std::pmr::memory_resource* memory = arena.reset();
+                    std::uint64_t allocations_before = allocation_count.load(std::memory_order_relaxed);
+                    auto start = std::chrono::steady_clock::now();
+                    runCase(bench, *scheduler, scratch, gantt, memory);
+                    auto stop = std::chrono::steady_clock::now();
+                    allocations += allocation_count.load(std::memory_order_relaxed) - allocations_before;
+                    elapsed_ns += std::chrono::duration<double, std::nano>(stop - start).count();
+                    decisions += gantt.slices();
+                    runs++;
+                } while (elapsed_ns < min_time_ms * 1e6);
+
+                std::cout << bench.name << "," << shape << "," << n << "," << runs << "," << decisions / runs << ","
+                          << (decisions ? elapsed_ns / decisions : 0) << "," << peakRssKb() << ","
+                          << allocations / runs << "\n"
+                          << std::flush;
+            }
+            if (max_n / 10 < n) break;
+        }
+    }
+    return 0;
+}
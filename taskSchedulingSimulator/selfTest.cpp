@@ -0,0 +1,411 @@
+// Checks the simulator's fast paths against plain references, and snapshots
+// against the runs they came from. Prints each failed check and exits
+// non-zero if there was one; `make check` runs it.
+#define SIMULATOR_NO_MAIN
+#include "taskScheduling.cpp"
+
+#include <cstdlib>
+#include <set>
+#include <unistd.h>
+
+static int failures = 0;
+
+void expect(bool ok, const std::string& what) {
+    if (ok) return;
+    std::cerr << "FAIL: " << what << "\n";
+    failures++;
+}
+
+// `n` processes arriving about every `gap`, with bursts up to `max_burst`.
+std::vector<Process> randomWorkload(size_t n, SimTime gap, SimTime max_burst, std::uint64_t seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<SimTime> step(0, 2 * gap);
+    std::uniform_int_distribution<SimTime> burst(1, max_burst);
+    std::uniform_int_distribution<int> priority(1, 5);
+    std::vector<Process> processes;
+    SimTime t = 0;
+    for (size_t i = 0; i < n; ++i) {
+        t += step(gen);
+        Process p{(std::uint32_t)i, t, burst(gen), priority(gen)};
+        p.deadline = t + p.burst_time * priority(gen);
+        processes.push_back(p);
+    }
+    return processes;
+}
+
+std::vector<GanttSegment> slices(const Gantt& gantt) {
+    std::vector<GanttSegment> out;
+    gantt.forEach([&](const GanttSegment& s) { out.push_back(s); });
+    return out;
+}
+
+bool sameSlices(const std::vector<GanttSegment>& a, const std::vector<GanttSegment>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const GanttSegment& x, const GanttSegment& y) {
+        return x.pid == y.pid && x.start == y.start && x.length == y.length;
+    });
+}
+
+bool sameMetrics(const RunMetrics& a, const RunMetrics& b) {
+    return a.completed == b.completed && a.total_waiting == b.total_waiting && a.total_turnaround == b.total_turnaround &&
+           a.total_burst == b.total_burst && a.deadline_misses == b.deadline_misses &&
+           a.latency.waiting.percentile(0.99) == b.latency.waiting.percentile(0.99) &&
+           a.latency.response.percentile(0.99) == b.latency.response.percentile(0.99);
+}
+
+bool sameProcess(const Process& a, const Process& b) {
+    return a.pid == b.pid && a.arrival_time == b.arrival_time && a.burst_time == b.burst_time &&
+           a.priority == b.priority && a.remaining_time == b.remaining_time && a.deadline == b.deadline &&
+           a.vruntime == b.vruntime && a.response_time == b.response_time && a.seq == b.seq;
+}
+
+struct BranchRun {
+    std::vector<GanttSegment> chart;
+    RunMetrics metrics;
+    SimTime total_time = 0;
+};
+
+BranchRun runBranch(Scheduler& scheduler, const std::vector<Process>& workload, const std::vector<int>& order,
+                    const SimSnapshot& from) {
+    BranchRun run;
+    Gantt gantt;
+    BranchFeed feed(workload, order, from, std::numeric_limits<SimTime>::max(), gantt, run.metrics);
+    scheduler.run(feed, gantt, run.total_time);
+    run.chart = slices(gantt);
+    return run;
+}
+
+bool chartHasRounds(const SimSnapshot& snapshot) {
+    for (const auto& chunk : snapshot.gantt) {
+        for (const auto& segment : *chunk) {
+            if (segment.pid == Gantt::ROUNDS_MARK) return true;
+        }
+    }
+    return false;
+}
+
+// Every policy, cut at several times: the snapshot survives a save and load,
+// and a run resumed from the file matches one resumed from memory. Policies
+// whose ready order is a function of the processes also match the run that
+// was never stopped. RR's long bursts make its charts hold compressed rounds.
+void checkSnapshots() {
+    char path[] = "/tmp/schedSelfTestXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        expect(false, "snapshot: can't create a temporary file");
+        return;
+    }
+    close(fd);
+    const std::vector<Process> workload = randomWorkload(200, 20, 400, 1);
+    const std::vector<int> order = arrivalOrder(workload);
+    bool saw_rounds = false;
+    for (const std::string type : {"fcfs", "sjf", "srtf", "priority", "rr", "mlq", "mlfq", "lottery", "cfs", "edf"}) {
+        SchedulerOptions options;
+        options.quantum = 4;
+        std::unique_ptr<Scheduler> scheduler = makeScheduler(type, options);
+        std::vector<Process> whole = workload;
+        Gantt gantt;
+        SimTime total_time = 0;
+        scheduler->schedule(whole, gantt, total_time);
+        const std::vector<GanttSegment> uninterrupted = slices(gantt);
+        const bool resumes_exactly = type == "fcfs" || type == "sjf" || type == "srtf" || type == "priority" || type == "edf";
+
+        for (SimTime at : {0, 500, 3000, 20000}) {
+            std::string what = "snapshot: " + type + " at " + std::to_string(at);
+            SimSnapshot taken = runPrefix(*scheduler, workload, order, at);
+            if (type == "rr") saw_rounds |= chartHasRounds(taken);
+            SimSnapshot loaded;
+            if (!taken.save(path, workloadFingerprint(workload)) || !loaded.load(path, workload)) {
+                expect(false, what + " doesn't load back");
+                continue;
+            }
+            expect(loaded.time == taken.time && loaded.cursor == taken.cursor && loaded.admitted == taken.admitted &&
+                       std::equal(loaded.live.begin(), loaded.live.end(), taken.live.begin(), taken.live.end(), sameProcess) &&
+                       sameMetrics(loaded.metrics, taken.metrics),
+                   what + " loads back different");
+
+            BranchRun from_memory = runBranch(*scheduler, workload, order, taken);
+            BranchRun from_file = runBranch(*scheduler, workload, order, loaded);
+            expect(sameSlices(from_file.chart, from_memory.chart) && sameMetrics(from_file.metrics, from_memory.metrics) &&
+                       from_file.total_time == from_memory.total_time,
+                   what + " resumes differently from the file");
+            if (resumes_exactly) {
+                expect(sameSlices(from_memory.chart, uninterrupted) &&
+                           sameMetrics(from_memory.metrics, collectMetrics(whole)) && from_memory.total_time == total_time,
+                       what + " resumes differently from the uninterrupted run");
+            }
+        }
+    }
+    expect(saw_rounds, "snapshot: no RR snapshot held compressed rounds");
+
+    std::vector<Process> other = workload;
+    other[0].burst_time++;
+    SimSnapshot loaded;
+    expect(!loaded.load(path, other), "snapshot: loads against a different workload");
+    std::remove(path);
+}
+
+// Random inserts, cancels and pops against a std::set ordered by (time, tie),
+// with delays reaching every level of the wheel, from a start before zero.
+void checkTimerWheel() {
+    std::mt19937_64 gen(16);
+    TimerWheel wheel;
+    const SimTime origin = -1000;
+    wheel.startAt(origin);
+    std::set<std::tuple<SimTime, std::uint64_t, int>> reference;
+    std::vector<std::pair<TimerWheel::Handle, std::tuple<SimTime, std::uint64_t, int>>> pending;
+    SimTime now = origin;
+    const int failed_before = failures;
+    for (int op = 0; op < 200000 && failures == failed_before; ++op) {
+        std::uint64_t roll = gen() % 8;
+        if (roll < 4 || reference.empty()) {
+            int bits = gen() % 41;
+            SimTime time = now + (SimTime)(gen() & ((1ull << bits) - 1));
+            std::tuple<SimTime, std::uint64_t, int> event{time, gen(), op};
+            pending.push_back({wheel.insert(time, std::get<1>(event), op), event});
+            reference.insert(event);
+        } else if (roll < 5) {
+            size_t i = gen() % pending.size();
+            wheel.cancel(pending[i].first);
+            reference.erase(pending[i].second);
+            pending[i] = pending.back();
+            pending.pop_back();
+        } else {
+            auto first = reference.begin();
+            now = wheel.nextTime();
+            expect(now == std::get<0>(*first), "timer wheel: next time differs from std::set");
+            int payload = wheel.pop();
+            expect(payload == std::get<2>(*first), "timer wheel: pop order differs from std::set");
+            auto popped = std::find_if(pending.begin(), pending.end(), [&](const auto& e) { return std::get<2>(e.second) == payload; });
+            if (popped != pending.end()) {
+                *popped = pending.back();
+                pending.pop_back();
+            }
+            reference.erase(first);
+        }
+        expect(wheel.size() == reference.size(), "timer wheel: size differs from std::set");
+    }
+}
+
+// Arrivals before zero are admitted when the run starts, at zero.
+void checkEarlyArrivals() {
+    std::vector<Process> processes = {{0, -3, 5, 1}, {1, 2, 3, 2}};
+    Gantt gantt;
+    SimTime total_time = 0;
+    makeScheduler("fcfs", SchedulerOptions())->schedule(processes, gantt, total_time);
+    expect(sameSlices(slices(gantt), {{0, 0, 5}, {1, 5, 3}}) && processes[0].turnaround_time == 8,
+           "timer wheel: arrival before zero scheduled wrongly");
+}
+
+bool sameJobs(const Process& a, const Process& b) {
+    return a.arrival_time == b.arrival_time && a.burst_time == b.burst_time && a.priority == b.priority;
+}
+
+// Philox against the Random123 known-answer vectors, then the generator: the
+// same workload from one thread and from three, a seek that matches the tail
+// of a run from zero, and streamed runs that match loaded ones.
+void checkGenerator() {
+    using Block = std::array<std::uint32_t, 4>;
+    expect(philox({0, 0, 0, 0}, 0) == Block{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8} &&
+               philox({~0u, ~0u, ~0u, ~0u}, ~0ull) == Block{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd} &&
+               philox({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, 0x299f31d0a4093822ull) ==
+                   Block{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1},
+           "generator: Philox4x32-10 doesn't match the known-answer vectors");
+
+    WorkloadSpec spec;
+    spec.arrivals = WorkloadSpec::Arrivals::MMPP;
+    spec.rates[0] = 0.1;
+    spec.rates[1] = 0.5;
+    spec.sojourn = 500;
+    spec.seed = 20;
+    const size_t n = 20000;
+    ProcessNames names;
+    const std::vector<Process> one = generateRandomProcesses(spec, n, 0, 1, names);
+    ProcessNames other_names;
+    const std::vector<Process> three = generateRandomProcesses(spec, n, 0, 3, other_names);
+    expect(one.size() == n && std::equal(one.begin(), one.end(), three.begin(), three.end(), sameJobs),
+           "generator: output depends on the thread count");
+
+    const SimTime from = one[n / 2].arrival_time;
+    auto tail = std::lower_bound(one.begin(), one.end(), from, [](const Process& p, SimTime t) { return p.arrival_time < t; });
+    const std::vector<Process> seeked = generateRandomProcesses(spec, one.end() - tail, from, 2, other_names);
+    expect(std::equal(tail, one.end(), seeked.begin(), seeked.end(), sameJobs),
+           "generator: seeking doesn't match the tail of a run from zero");
+
+    WorkloadGenerator generator(spec);
+    for (const std::string type : {"fcfs", "srtf", "rr", "mlfq", "lottery", "cfs"}) {
+        std::unique_ptr<Scheduler> scheduler = makeScheduler(type, SchedulerOptions());
+        std::vector<Process> loaded = one;
+        Gantt gantt;
+        SimTime loaded_time = 0;
+        scheduler->schedule(loaded, gantt, loaded_time);
+
+        GeneratedTraceReader reader(generator, n, 0, 2);
+        Gantt streamed_gantt;
+        streamed_gantt.disable();
+        RunMetrics streamed;
+        SimTime streamed_time = 0;
+        TraceStreamFeed feed(reader, streamed_gantt, streamed);
+        scheduler->run(feed, streamed_gantt, streamed_time);
+        expect(sameMetrics(streamed, collectMetrics(loaded)) && streamed_time == loaded_time &&
+                   streamed_gantt.slices() == gantt.slices(),
+               "generator: streamed " + type + " run differs from the loaded one");
+    }
+}
+
+// Random constrained-deadline task sets: analyzeEDF() against the demand
+// bound checked at every instant up to two hyperperiods past the largest
+// deadline, and, when utilization allows, against a simulated EDF run over
+// the hyperperiod, which misses a deadline exactly when the set is infeasible.
+void checkSchedulability() {
+    std::mt19937_64 gen(15);
+    for (int set = 0; set < 300; ++set) {
+        std::vector<PeriodicTask> tasks;
+        size_t n = 2 + gen() % 4;
+        SimTime max_deadline = 0;
+        double utilization = 0;
+        for (size_t i = 0; i < n; ++i) {
+            SimTime period = 3 + gen() % 18;
+            SimTime wcet = 1 + gen() % (period / 2);
+            SimTime deadline = wcet + gen() % (period - wcet + 1);
+            tasks.push_back({(std::uint32_t)i, period, wcet, deadline, 0});
+            max_deadline = std::max(max_deadline, deadline);
+            utilization += (double)wcet / period;
+        }
+        Schedulability verdict = analyzeEDF(tasks);
+        std::string what = "schedulability: set " + std::to_string(set);
+        if (utilization > 1) {
+            expect(!verdict.feasible, what + " is over-utilized but called feasible");
+            continue;
+        }
+        SimTime hyperperiod = periodicHorizon(tasks);
+        bool feasible = true;
+        for (SimTime t = 1; t <= 2 * hyperperiod + max_deadline && feasible; ++t) {
+            SimTime demand = 0;
+            for (const auto& task : tasks) {
+                if (t >= task.deadline) demand += ((t - task.deadline) / task.period + 1) * task.wcet;
+            }
+            feasible = demand <= t;
+        }
+        expect(verdict.feasible == feasible, what + ": QPA disagrees with the brute-force demand check");
+
+        RunMetrics metrics;
+        Gantt gantt;
+        gantt.disable();
+        SimTime total_time = 0;
+        PeriodicFeed feed(tasks, hyperperiod, metrics);
+        EDFScheduler().run(feed, gantt, total_time);
+        expect((metrics.deadline_misses == 0) == feasible, what + ": EDF simulation disagrees with the demand check");
+    }
+}
+
+// Round robin with every slice dispatched one at a time, for comparison with
+// RoundRobinScheduler's fast-forwarded rounds.
+class SliceByQuantum {
+public:
+    explicit SliceByQuantum(SimTime quantum) : quantum(quantum) {}
+    SliceByQuantum(const SliceByQuantum& config, std::pmr::memory_resource*) : quantum(config.quantum) {}
+
+    SimTime limit(const Process& p) const { return std::min(quantum, p.remaining_time); }
+    template <typename Feed, typename Queue>
+    bool skipAhead(Feed&, Gantt&, const Queue&, SimTime&) { return false; }
+
+private:
+    SimTime quantum;
+};
+
+using PlainRoundRobin = PolicyScheduler<FifoQueue, NonPreemptive, SliceByQuantum>;
+
+bool sameResults(const Process& a, const Process& b) {
+    return a.pid == b.pid && a.waiting_time == b.waiting_time && a.turnaround_time == b.turnaround_time &&
+           a.response_time == b.response_time;
+}
+
+// Long bursts and sparse arrivals, so most of each run is fast-forwarded:
+// the same slices, results and end time as slice-by-slice RR, and the same
+// state when stopped partway through.
+void checkRoundRobinRounds() {
+    for (std::uint64_t seed = 1; seed <= 4; ++seed) {
+        const std::vector<Process> workload = randomWorkload(300, 40 * seed, 2000, seed);
+        const std::vector<int> order = arrivalOrder(workload);
+        for (SimTime quantum : {1, 2, 3, 5, 8}) {
+            std::string what = "rr rounds: seed " + std::to_string(seed) + ", quantum " + std::to_string(quantum);
+            RoundRobinScheduler fast(quantum);
+            PlainRoundRobin plain{SliceByQuantum(quantum)};
+            std::vector<Process> fast_run = workload, plain_run = workload;
+            Gantt fast_gantt, plain_gantt;
+            SimTime fast_time = 0, plain_time = 0;
+            fast.schedule(fast_run, fast_gantt, fast_time);
+            plain.schedule(plain_run, plain_gantt, plain_time);
+            expect(sameSlices(slices(fast_gantt), slices(plain_gantt)) && fast_time == plain_time &&
+                       fast_gantt.slices() == plain_gantt.slices() &&
+                       std::equal(fast_run.begin(), fast_run.end(), plain_run.begin(), plain_run.end(), sameResults),
+                   what + " differs from slice-by-slice RR");
+
+            SimSnapshot fast_cut = runPrefix(fast, workload, order, fast_time / 3);
+            SimSnapshot plain_cut = runPrefix(plain, workload, order, fast_time / 3);
+            expect(fast_cut.time == plain_cut.time &&
+                       std::equal(fast_cut.live.begin(), fast_cut.live.end(), plain_cut.live.begin(), plain_cut.live.end(),
+                                  sameProcess),
+                   what + " stops in a different state from slice-by-slice RR");
+        }
+    }
+}
+
+// SJF, SRTF and Priority pick the same processes by heap and by scan, over
+// the column table, over a feed, and in runs stopped and resumed partway, on
+// workloads that include processes with no burst.
+void checkScanSelection() {
+    for (std::uint64_t seed = 1; seed <= 3; ++seed) {
+        std::vector<Process> workload = randomWorkload(500, 3, 12, seed);
+        for (size_t i = 0; i < workload.size(); i += 7) workload[i].burst_time = 0;
+        const std::vector<int> order = arrivalOrder(workload);
+        for (const std::string type : {"sjf", "srtf", "priority"}) {
+            std::string what = "scan: " + type + ", seed " + std::to_string(seed);
+            SchedulerOptions options;
+            std::unique_ptr<Scheduler> heap = makeScheduler(type, options);
+            options.select = ReadySelect::Scan;
+            std::unique_ptr<Scheduler> scan = makeScheduler(type, options);
+
+            std::vector<Process> by_heap = workload, by_table = workload, by_feed = workload;
+            Gantt heap_gantt, table_gantt, feed_gantt;
+            SimTime heap_time = 0, table_time = 0, feed_time = 0;
+            heap->schedule(by_heap, heap_gantt, heap_time);
+            scan->schedule(by_table, table_gantt, table_time);
+            VectorFeed feed(by_feed);
+            scan->run(feed, feed_gantt, feed_time);
+            expect(sameSlices(slices(table_gantt), slices(heap_gantt)) && table_time == heap_time &&
+                       std::equal(by_table.begin(), by_table.end(), by_heap.begin(), by_heap.end(), sameResults),
+                   what + ": the table scan differs from the heap");
+            expect(sameSlices(slices(feed_gantt), slices(heap_gantt)) && feed_time == heap_time &&
+                       std::equal(by_feed.begin(), by_feed.end(), by_heap.begin(), by_heap.end(), sameResults),
+                   what + ": the feed scan differs from the heap");
+
+            SimSnapshot heap_cut = runPrefix(*heap, workload, order, heap_time / 2);
+            SimSnapshot scan_cut = runPrefix(*scan, workload, order, heap_time / 2);
+            expect(scan_cut.time == heap_cut.time &&
+                       std::equal(scan_cut.live.begin(), scan_cut.live.end(), heap_cut.live.begin(), heap_cut.live.end(),
+                                  sameProcess),
+                   what + ": a stopped scan run differs from the heap");
+            BranchRun heap_branch = runBranch(*heap, workload, order, heap_cut);
+            BranchRun scan_branch = runBranch(*scan, workload, order, scan_cut);
+            expect(sameSlices(scan_branch.chart, heap_branch.chart) && sameMetrics(scan_branch.metrics, heap_branch.metrics),
+                   what + ": a resumed scan run differs from the heap");
+        }
+    }
+}
+
+int main() {
+    checkSnapshots();
+    checkTimerWheel();
+    checkEarlyArrivals();
+    checkGenerator();
+    checkSchedulability();
+    checkRoundRobinRounds();
+    checkScanSelection();
+    if (failures) {
+        std::cerr << failures << " self-test checks failed\n";
+        return 1;
+    }
+    std::cout << "Self-test passed\n";
+    return 0;
+}
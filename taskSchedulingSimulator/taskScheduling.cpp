@@ -8,349 +8,4961 @@
 #include <chrono>
 #include <map>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <cstddef>
 #include <numeric>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <cstdint>
+#include <limits>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <stdexcept>
+#include <thread>
+#include <atomic>
+#include <csignal>
+#include <mutex>
+#include <condition_variable>
+#include <array>
+#include <deque>
+#include <functional>
+#include <sstream>
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+using SimTime = std::int64_t;
+
+// Process ids are interned into dense 32-bit handles when a workload is built;
+// schedulers only ever compare handles, and names are looked up for output.
+class ProcessNames {
+public:
+    std::uint32_t intern(const std::string& name) {
+        auto it = index.find(name);
+        if (it != index.end()) return it->second;
+        std::uint32_t pid = names.size();
+        names.push_back(name);
+        versions.push_back(1);
+        index.emplace(name, pid);
+        return pid;
+    }
+
+    // For feeds that recycle handles: binds `pid` to `name` without interning.
+    void assign(std::uint32_t pid, const std::string& name) {
+        if (pid >= names.size()) {
+            names.resize(pid + 1);
+            versions.resize(pid + 1, 0);
+        }
+        names[pid] = name;
+        versions[pid]++;
+    }
+
+    const std::string& name(std::uint32_t pid) const { return names[pid]; }
+    // Bumped whenever `pid` is bound to a name, so writers can tell a rebinding.
+    std::uint32_t version(std::uint32_t pid) const { return versions[pid]; }
+    size_t size() const { return names.size(); }
+
+private:
+    std::vector<std::string> names;
+    std::vector<std::uint32_t> versions;
+    std::unordered_map<std::string, std::uint32_t> index;
+};
+
+// Buffered output to a file descriptor. Numbers are formatted with
+// std::to_chars (doubles as iostream's default "%g" with six digits, so text
+// output is unchanged) and reach the descriptor in 1 MiB write() batches.
+class ResultWriter {
+public:
+    explicit ResultWriter(int fd, bool owned = false) : fd(fd), owned(owned), buffer(new char[capacity]) {}
+    ~ResultWriter() {
+        flush();
+        if (owned) ::close(fd);
+    }
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    // A writer for `path`, truncating it, or nullptr if it can't be opened.
+    static std::unique_ptr<ResultWriter> open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        return fd < 0 ? nullptr : std::make_unique<ResultWriter>(fd, true);
+    }
+
+    int descriptor() const { return fd; }
+
+    void put(std::string_view text) { raw(text.data(), text.size()); }
+    void put(char c) {
+        if (used == capacity) flush();
+        buffer[used++] = c;
+    }
+    template <typename T>
+    std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, char>> put(T value) {
+        if (capacity - used < 24) flush();
+        used = std::to_chars(buffer.get() + used, buffer.get() + capacity, value).ptr - buffer.get();
+    }
+    void put(double value) {
+        if (capacity - used < 32) flush();
+        used = std::to_chars(buffer.get() + used, buffer.get() + capacity, value, std::chars_format::general, 6).ptr - buffer.get();
+    }
+
+    void raw(const void* data, size_t bytes) {
+        if (bytes > capacity - used) {
+            flush();
+            if (bytes >= capacity) {
+                writeAll(static_cast<const char*>(data), bytes);
+                return;
+            }
+        }
+        std::memcpy(buffer.get() + used, data, bytes);
+        used += bytes;
+    }
+
+    // Appends everything written to `source` so far.
+    void copyFrom(int source) {
+        ::lseek(source, 0, SEEK_SET);
+        flush();
+        ssize_t n;
+        while ((n = ::read(source, buffer.get(), capacity)) > 0) {
+            writeAll(buffer.get(), n);
+        }
+    }
+
+    void flush() {
+        writeAll(buffer.get(), used);
+        used = 0;
+    }
+
+private:
+    static constexpr size_t capacity = 1 << 20;
+
+    void writeAll(const char* data, size_t bytes) {
+        while (bytes > 0) {
+            ssize_t n = ::write(fd, data, bytes);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            data += n;
+            bytes -= n;
+        }
+    }
+
+    int fd;
+    bool owned;
+    std::unique_ptr<char[]> buffer;
+    size_t used = 0;
+};
+
+// Result output formats. Text is the human-readable report; CSV lists the
+// metrics as "metric,value" rows, a blank line, then "process,start,length"
+// rows; Binary is the stream described at writeBinaryHeader().
+enum class OutputFormat { Text, CSV, Binary };
+
+constexpr char OUTPUT_MAGIC[8] = {'S', 'C', 'H', 'E', 'D', 'O', 'U', 'T'};
+constexpr std::uint32_t OUTPUT_VERSION = 2;
+enum OutputRecord : std::uint8_t { RECORD_NAME = 1, RECORD_SEGMENT = 2, RECORD_METRICS = 3, RECORD_LATENCY = 4, RECORD_OVERHEAD = 5 };
+
+// One contiguous stretch of CPU time given to a single process.
+#pragma pack(push, 4)
+struct GanttSegment {
+    std::uint32_t pid;
+    SimTime start;
+    SimTime length;
+};
+#pragma pack(pop)
+
+// Writes Gantt segments in one output format. The binary format refers to
+// processes by pid and defines each pid's name in a name record before its
+// first segment, and again whenever the pid is rebound.
+class SegmentEncoder {
+public:
+    SegmentEncoder(OutputFormat format, const ProcessNames& names) : format(format), names(names) {}
+
+    OutputFormat outputFormat() const { return format; }
+
+    void write(ResultWriter& out, const GanttSegment& segment) {
+        const std::string& name = names.name(segment.pid);
+        switch (format) {
+            case OutputFormat::Text:
+                out.put(name);
+                out.put(" (");
+                out.put(segment.length);
+                out.put(") ");
+                break;
+            case OutputFormat::CSV:
+                out.put(name);
+                out.put(',');
+                out.put(segment.start);
+                out.put(',');
+                out.put(segment.length);
+                out.put('\n');
+                break;
+            case OutputFormat::Binary: {
+                if (segment.pid >= emitted.size()) emitted.resize(segment.pid + 1, 0);
+                if (emitted[segment.pid] != names.version(segment.pid)) {
+                    emitted[segment.pid] = names.version(segment.pid);
+                    std::uint32_t length = name.size();
+                    out.put(char(RECORD_NAME));
+                    out.raw(&segment.pid, sizeof(segment.pid));
+                    out.raw(&length, sizeof(length));
+                    out.put(name);
+                }
+                out.put(char(RECORD_SEGMENT));
+                out.raw(&segment, sizeof(segment));
+                break;
+            }
+        }
+    }
+
+private:
+    OutputFormat format;
+    const ProcessNames& names;
+    std::vector<std::uint32_t> emitted;  // name version last written per pid
+};
+
+// What dispatching costs the CPU, in simulated time. All zero, the default, is
+// the free dispatch the schedulers assume. A context switch, to a process other
+// than the one that ran last, costs `switch_cost`, and the process switched in
+// then refills its cache: the full `warmup` if it never ran on this CPU, else
+// warmup * (1 - e^(-away / warmup_decay)) after `away` units off it, so one
+// that was barely gone pays little. Each decision also costs `decision_cost`
+// per unit of work the policy did to make it: one for a FIFO pop, the depth of
+// a heap or tree, or every entry a linear scan looked at.
+struct DispatchCosts {
+    double switch_cost = 0;
+    double warmup = 0;
+    double warmup_decay = 0;  // 0 charges the full warmup on every switch
+    double decision_cost = 0;
+
+    bool enabled() const { return switch_cost > 0 || warmup > 0 || decision_cost > 0; }
+};
+
+// Work of a decision over `n` entries kept in a heap or tree: its depth.
+inline std::uint32_t treeWork(size_t n) {
+    return 64 - __builtin_clzll((std::uint64_t)n | 1);
+}
+
+// Charges DispatchCosts to one CPU's dispatches as its Gantt chart receives
+// them. Schedulers still decide as if dispatch were free; the meter replays
+// their slices in order with each one's overhead in front of it, so a slice
+// starts at its planned start or once the previous slice and this overhead are
+// done, whichever is later. Idle time absorbs the delay built up so far, and
+// whatever is left at the end stretches the run. Time away is measured on the
+// planned timeline.
+class OverheadMeter {
+public:
+    OverheadMeter() = default;
+    explicit OverheadMeter(const DispatchCosts& costs) : costs(costs) {}
+
+    void dispatch(std::uint32_t pid, SimTime start, SimTime length, std::uint32_t work) {
+        double overhead = charge(pid, start, work);
+        clock = std::max(clock, (double)start) + overhead + length;
+        planned_end = start + length;
+        if (costs.warmup > 0) ranUntil(pid, planned_end);
+    }
+
+    // `rounds` round-robin rounds as Gantt::appendRounds() takes them. After
+    // the first round every slice is a switch back from (count - 1) quanta
+    // away with nothing idle in between, so the rest is charged in O(count).
+    void dispatchRounds(const std::uint32_t* pids, size_t count, SimTime start, SimTime quantum, SimTime rounds) {
+        if (count == 0 || rounds <= 0) return;
+        for (size_t i = 0; i < count; ++i) dispatch(pids[i], start + (SimTime)i * quantum, quantum, 1);
+        SimTime repeats = rounds - 1;
+        if (repeats == 0) return;
+        double slices = (double)repeats * count;
+        double overhead = slices * costs.decision_cost;
+        decisions += repeats * count;
+        decision_time += slices * costs.decision_cost;
+        if (count > 1) {
+            double warm = costs.warmup_decay > 0
+                              ? costs.warmup * -std::expm1(-(double)((count - 1) * quantum) / costs.warmup_decay)
+                              : costs.warmup;
+            switches += repeats * count;
+            switch_time += slices * costs.switch_cost;
+            warmup_time += slices * warm;
+            overhead += slices * (costs.switch_cost + warm);
+        }
+        const SimTime round = quantum * (SimTime)count;
+        clock += overhead + (double)repeats * round;
+        planned_end = start + rounds * round;
+        if (costs.warmup > 0) {
+            for (size_t i = 0; i < count; ++i) ranUntil(pids[i], start + repeats * round + (SimTime)(i + 1) * quantum);
+        }
+    }
+
+    // `pid` finished; a later process given the same pid starts cold.
+    void release(std::uint32_t pid) {
+        if (pid < last_ran.size()) last_ran[pid] = -1;
+        if (pid == last_pid) last_pid = NONE;
+    }
+
+    std::uint64_t decisionCount() const { return decisions; }
+    std::uint64_t switchCount() const { return switches; }
+    double switchTime() const { return switch_time; }
+    double warmupTime() const { return warmup_time; }
+    double decisionTime() const { return decision_time; }
+    double overhead() const { return switch_time + warmup_time + decision_time; }
+    // How much later than planned the last slice ended.
+    double delay() const { return std::max(0.0, clock - planned_end); }
+
+private:
+    static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+    // Charges the switch, warmup and decision costs of dispatching `pid` at `start`.
+    double charge(std::uint32_t pid, SimTime start, std::uint32_t work) {
+        double overhead = work * costs.decision_cost;
+        if (work > 0) decisions++;
+        decision_time += overhead;
+        if (pid != last_pid) {
+            double warm = warmupFor(pid, start);
+            switches++;
+            switch_time += costs.switch_cost;
+            warmup_time += warm;
+            overhead += costs.switch_cost + warm;
+            last_pid = pid;
+        }
+        return overhead;
+    }
+
+    double warmupFor(std::uint32_t pid, SimTime now) const {
+        if (costs.warmup == 0) return 0;
+        if (pid >= last_ran.size() || last_ran[pid] < 0 || costs.warmup_decay <= 0) return costs.warmup;
+        return costs.warmup * -std::expm1(-(double)(now - last_ran[pid]) / costs.warmup_decay);
+    }
+
+    void ranUntil(std::uint32_t pid, SimTime end) {
+        if (pid >= last_ran.size()) last_ran.resize(pid + 1, -1);
+        last_ran[pid] = end;
+    }
+
+    DispatchCosts costs;
+    std::uint64_t decisions = 0;
+    std::uint64_t switches = 0;
+    double switch_time = 0;
+    double warmup_time = 0;
+    double decision_time = 0;
+    double clock = 0;          // when the last slice ended once overhead is paid
+    SimTime planned_end = 0;   // when the schedule had it end
+    std::uint32_t last_pid = NONE;  // what ran last; NONE before the first slice or once it finished
+    std::vector<SimTime> last_ran;  // planned end of each pid's last slice; -1 if it never ran
+};
+
+// Immutable run of segments, shared by every run resumed from one snapshot.
+using GanttChunk = std::shared_ptr<const std::vector<GanttSegment>>;
+
+// Gantt chart of a run. Segments normally all stay in memory; a streaming run
+// attaches a spill file instead, and segments that can no longer grow are
+// written to it, already encoded, so only the tail of the chart is kept. A
+// run that only wants metrics can turn recording off entirely. A run resumed
+// from a snapshot starts with the snapshot's chunks as a shared prefix.
+//
+// Whole round-robin rounds are stored compressed, as a ROUNDS_MARK entry
+// {ROUNDS_MARK, start, quantum}, then {count, rounds, 0}, then one {pid, 0, 0}
+// per process in turn order, and expanded into slices only when written out.
+class Gantt {
+public:
+    static constexpr std::uint32_t ROUNDS_MARK = std::numeric_limits<std::uint32_t>::max();
+
+    // Extends the last segment when `pid` simply keeps running, otherwise opens
+    // a new one. `work` is what the decision behind it cost the policy (see
+    // DispatchCosts); 0 if the slice only continues one already decided.
+    void append(std::uint32_t pid, SimTime start, SimTime length, std::uint32_t work) {
+        appended++;
+        if (meter) meter->dispatch(pid, start, length, work);
+        if (!recording) return;
+        if (!segments.empty() && !ends_in_rounds && segments.back().pid == pid &&
+            segments.back().start + segments.back().length == start) {
+            segments.back().length += length;
+            return;
+        }
+        if (spill && segments.size() >= spill_batch) drain(1);
+        segments.push_back({pid, start, length});
+        ends_in_rounds = false;
+    }
+
+    // `rounds` rounds from `start` in which each of `count` processes runs
+    // `quantum` in turn; the same as appending every slice, in O(count).
+    void appendRounds(const std::uint32_t* pids, size_t count, SimTime start, SimTime quantum, SimTime rounds) {
+        appended += count * rounds;
+        if (meter) meter->dispatchRounds(pids, count, start, quantum, rounds);
+        if (!recording) return;
+        if (spill && segments.size() >= spill_batch) drain(1);
+        segments.push_back({ROUNDS_MARK, start, quantum});
+        segments.push_back({(std::uint32_t)count, rounds, 0});
+        for (size_t i = 0; i < count; ++i) segments.push_back({pids[i], 0, 0});
+        ends_in_rounds = true;
+    }
+
+    // Calls fn(segment) for every slice in [begin, end), expanding rounds.
+    template <typename Fn>
+    static void expand(const GanttSegment* begin, const GanttSegment* end, Fn&& fn) {
+        for (const GanttSegment* entry = begin; entry < end;) {
+            if (entry->pid != ROUNDS_MARK) {
+                fn(*entry++);
+                continue;
+            }
+            SimTime start = entry->start, quantum = entry->length;
+            size_t count = entry[1].pid;
+            SimTime rounds = entry[1].start;
+            const GanttSegment* turn = entry + 2;
+            for (SimTime round = 0; round < rounds; ++round) {
+                for (size_t i = 0; i < count; ++i, start += quantum) fn(GanttSegment{turn[i].pid, start, quantum});
+            }
+            entry = turn + count;
+        }
+    }
+
+    // Whether [begin, end) is a chart expand() can walk: plain segments of
+    // processes below `pid_end`, and rounds blocks whose turn order fits in the
+    // range and names such processes. `tail` requires it to end in a plain
+    // segment, which a resumed run may extend.
+    static bool wellFormed(const GanttSegment* begin, const GanttSegment* end, std::uint32_t pid_end, bool tail) {
+        bool plain_last = false;
+        for (const GanttSegment* entry = begin; entry < end;) {
+            plain_last = entry->pid != ROUNDS_MARK;
+            if (plain_last) {
+                if (entry->pid >= pid_end || entry->length < 0) return false;
+                entry++;
+                continue;
+            }
+            if (end - entry < 2 || entry->length <= 0 || entry[1].start < 0 || entry[1].pid > end - entry - 2) {
+                return false;
+            }
+            const GanttSegment* turn = entry + 2;
+            entry = turn + entry[1].pid;
+            for (; turn < entry; ++turn) {
+                if (turn->pid >= pid_end) return false;
+            }
+        }
+        return !tail || plain_last;
+    }
+
+    // Writes out every buffered segment. Feeds that recycle pids call this
+    // before a finished process's pid can be handed to a new arrival.
+    void seal() {
+        if (spill) drain(0);
+    }
+
+    // `pid` finished and may be handed to a new arrival; the meter then
+    // treats whoever gets it next as a new process.
+    void release(std::uint32_t pid) {
+        if (meter) meter->release(pid);
+    }
+
+    void clear() {
+        prefix.clear();
+        segments.clear();
+        ends_in_rounds = false;
+        appended = 0;
+    }
+
+    // Starts from a snapshot's chart: `chunks` are shared, and `tail` (the
+    // last segment, if any) is copied so the resumed run can extend it.
+    void restore(const std::vector<GanttChunk>& chunks, const std::vector<GanttSegment>& tail) {
+        prefix = chunks;
+        segments = tail;
+        ends_in_rounds = false;
+    }
+
+    // The chart so far for a snapshot: the prefix plus a new chunk holding
+    // everything but the last segment, which goes to `tail`.
+    std::vector<GanttChunk> freeze(std::vector<GanttSegment>& tail) const {
+        std::vector<GanttChunk> chunks = prefix;
+        size_t n = segments.size() - std::min<size_t>(ends_in_rounds ? 0 : 1, segments.size());
+        if (n > 0) chunks.push_back(std::make_shared<const std::vector<GanttSegment>>(segments.begin(), segments.begin() + n));
+        tail.assign(segments.begin() + n, segments.end());
+        return chunks;
+    }
+
+    // Slices handed to append() since the last clear(), merged or not; one per dispatch.
+    size_t slices() const { return appended; }
+
+    void disable() { recording = false; }
+    bool enabled() const { return recording; }
+
+    // Has every slice from now on charged to `m` as well; nullptr stops it.
+    void meterTo(OverheadMeter* m) { meter = m; }
+
+    void spillTo(ResultWriter& file, SegmentEncoder& encoder) {
+        spill = &file;
+        spill_encoder = &encoder;
+    }
+
+    void print(ResultWriter& out, SegmentEncoder& encoder) const {
+        if (spill) {
+            spill->flush();
+            out.copyFrom(spill->descriptor());
+        }
+        forEach([&](const GanttSegment& entry) { encoder.write(out, entry); });
+    }
+
+    // Calls fn(segment) for every slice still held, rounds expanded; a
+    // spilled run's written-out slices aren't included.
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const auto& chunk : prefix) expand(chunk->data(), chunk->data() + chunk->size(), fn);
+        expand(segments.data(), segments.data() + segments.size(), fn);
+    }
+
+private:
+    static constexpr size_t spill_batch = 4096;
+
+    // Writes out all but the last `keep` segments; a trailing block of rounds
+    // can't be extended, so it goes out whole.
+    void drain(size_t keep) {
+        if (ends_in_rounds) keep = 0;
+        size_t n = segments.size() - std::min(keep, segments.size());
+        expand(segments.data(), segments.data() + n, [this](const GanttSegment& entry) { spill_encoder->write(*spill, entry); });
+        segments.erase(segments.begin(), segments.begin() + n);
+        if (segments.empty()) ends_in_rounds = false;
+    }
+
+    std::vector<GanttChunk> prefix;
+    std::vector<GanttSegment> segments;
+    bool ends_in_rounds = false;  // segments ends with a block of rounds
+    size_t appended = 0;
+    bool recording = true;
+    OverheadMeter* meter = nullptr;
+    ResultWriter* spill = nullptr;
+    SegmentEncoder* spill_encoder = nullptr;
+};
 
 struct Process {
-    std::string id;
-    int arrival_time;
-    int burst_time;
+    std::uint32_t pid;
+    SimTime arrival_time;
+    SimTime burst_time;
     int priority;
-    int remaining_time = 0;
-    int waiting_time = 0;
-    int turnaround_time = 0;
-    int deadline = 0;
-    double vruntime = 0.0;
+    SimTime remaining_time = 0;
+    SimTime waiting_time = 0;
+    SimTime turnaround_time = 0;
+    SimTime deadline = 0;
+    SimTime vruntime = 0;
+    SimTime response_time = -1;  // first dispatch minus arrival; -1 until dispatched
+    std::uint64_t seq = 0;  // admission order, set by the feed; breaks ties between equal keys
     bool finished = false;
 };
 
-void calculateMetrics(const std::vector<Process>& processes, int total_time, double& avg_wait, double& avg_turn, double& cpu_util, double& throughput) {
-    avg_wait = 0;
-    avg_turn = 0;
-    int total_burst_time = 0;
+// Records when `p` first gets the CPU, for its response time.
+inline void markDispatched(Process& p, SimTime now) {
+    if (p.response_time < 0) p.response_time = now - p.arrival_time;
+}
+
+template <typename T>
+void writePod(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readPod(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+// Log-linear histogram of non-negative times, in the style of HdrHistogram:
+// values below 2 * SUB are counted exactly, and above that each power of two
+// is split into SUB buckets, so a reported percentile is within 1/SUB of the
+// true one. The bucket array grows only as far as the largest value recorded
+// and is bounded by 64 - SUB_BITS powers of two whatever the run length.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 7;
+    static constexpr SimTime SUB = SimTime(1) << SUB_BITS;
+
+    void record(SimTime value) {
+        value = std::max<SimTime>(value, 0);
+        size_t i = bucketOf(value);
+        if (i >= counts.size()) counts.resize(i + 1, 0);
+        counts[i]++;
+        total++;
+        largest = std::max(largest, value);
+    }
+
+    std::uint64_t count() const { return total; }
+    SimTime max() const { return largest; }
+
+    void save(std::ostream& out) const {
+        writePod(out, (std::uint64_t)counts.size());
+        out.write(reinterpret_cast<const char*>(counts.data()), counts.size() * sizeof(std::uint64_t));
+        writePod(out, total);
+        writePod(out, largest);
+    }
+
+    bool load(std::istream& in) {
+        std::uint64_t buckets;
+        if (!readPod(in, buckets) || buckets > bucketOf(std::numeric_limits<SimTime>::max()) + 1) return false;
+        counts.resize(buckets);
+        in.read(reinterpret_cast<char*>(counts.data()), buckets * sizeof(std::uint64_t));
+        return readPod(in, total) && readPod(in, largest);
+    }
+
+    // The `q` quantile rounded up to the top of its bucket, capped at max().
+    SimTime percentile(double q) const {
+        if (total == 0) return 0;
+        std::uint64_t rank = std::max<std::uint64_t>(1, (std::uint64_t)std::ceil(q * total));
+        std::uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(highestIn(i), largest);
+        }
+        return largest;
+    }
+
+private:
+    static size_t bucketOf(SimTime value) {
+        int shift = std::max(0, 63 - __builtin_clzll((std::uint64_t)value | 1) - SUB_BITS);
+        return ((size_t)shift << SUB_BITS) + (size_t)(value >> shift);
+    }
+
+    static SimTime highestIn(size_t bucket) {
+        if (bucket < 2 * (size_t)SUB) return bucket;
+        int shift = bucket / SUB - 1;
+        SimTime sub = bucket % SUB + SUB;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::vector<std::uint64_t> counts;
+    std::uint64_t total = 0;
+    SimTime largest = 0;
+};
+
+// Tail-latency distributions of one group of finished processes. Slowdown
+// (turnaround over burst) is kept in hundredths; processes with no burst have
+// no slowdown. Jain's index over slowdowns, (sum x)^2 / (n * sum x^2), is 1
+// when every process was slowed equally and falls towards 1/n as one process
+// takes the brunt.
+struct LatencyStats {
+    static constexpr double SLOWDOWN_SCALE = 100;
+
+    LatencyHistogram waiting;
+    LatencyHistogram turnaround;
+    LatencyHistogram response;
+    LatencyHistogram slowdown;
+    double slowdown_sum = 0;
+    double slowdown_squares = 0;
+
+    void add(const Process& p) {
+        waiting.record(p.waiting_time);
+        turnaround.record(p.turnaround_time);
+        response.record(p.response_time);
+        if (p.burst_time > 0) {
+            double x = (double)p.turnaround_time / p.burst_time;
+            slowdown.record(std::llround(x * SLOWDOWN_SCALE));
+            slowdown_sum += x;
+            slowdown_squares += x * x;
+        }
+    }
+
+    void save(std::ostream& out) const {
+        for (const LatencyHistogram* h : {&waiting, &turnaround, &response, &slowdown}) h->save(out);
+        writePod(out, slowdown_sum);
+        writePod(out, slowdown_squares);
+    }
+
+    bool load(std::istream& in) {
+        for (LatencyHistogram* h : {&waiting, &turnaround, &response, &slowdown}) {
+            if (!h->load(in)) return false;
+        }
+        return readPod(in, slowdown_sum) && readPod(in, slowdown_squares);
+    }
+
+    double slowdownPercentile(double q) const { return slowdown.percentile(q) / SLOWDOWN_SCALE; }
+    double meanSlowdown() const { return slowdown.count() ? slowdown_sum / slowdown.count() : 0; }
+    double fairness() const {
+        return slowdown_squares > 0 ? slowdown_sum * slowdown_sum / (slowdown.count() * slowdown_squares) : 1;
+    }
+};
+
+// Running totals behind the summary metrics, folded in as processes finish so
+// a streaming run doesn't have to keep them.
+struct RunMetrics {
+    size_t completed = 0;
+    double total_waiting = 0;
+    double total_turnaround = 0;
+    SimTime total_burst = 0;
+    size_t with_deadline = 0;
+    size_t deadline_misses = 0;
+    LatencyStats latency;
+    std::map<int, LatencyStats> by_priority;
+
+    void add(const Process& p) {
+        completed++;
+        total_waiting += p.waiting_time;
+        total_turnaround += p.turnaround_time;
+        total_burst += p.burst_time;
+        if (p.deadline != 0) {
+            with_deadline++;
+            if (p.arrival_time + p.turnaround_time > p.deadline) deadline_misses++;
+        }
+        latency.add(p);
+        by_priority[p.priority].add(p);
+    }
+
+    void save(std::ostream& out) const {
+        writePod(out, (std::uint64_t)completed);
+        writePod(out, total_waiting);
+        writePod(out, total_turnaround);
+        writePod(out, total_burst);
+        writePod(out, (std::uint64_t)with_deadline);
+        writePod(out, (std::uint64_t)deadline_misses);
+        latency.save(out);
+        writePod(out, (std::uint64_t)by_priority.size());
+        for (const auto& [priority, stats] : by_priority) {
+            writePod(out, (std::int32_t)priority);
+            stats.save(out);
+        }
+    }
+
+    bool load(std::istream& in) {
+        std::uint64_t done, deadlines, misses, classes;
+        if (!readPod(in, done) || !readPod(in, total_waiting) || !readPod(in, total_turnaround) ||
+            !readPod(in, total_burst) || !readPod(in, deadlines) || !readPod(in, misses) || !latency.load(in) ||
+            !readPod(in, classes)) {
+            return false;
+        }
+        completed = done;
+        with_deadline = deadlines;
+        deadline_misses = misses;
+        by_priority.clear();
+        for (std::uint64_t c = 0; c < classes; ++c) {
+            std::int32_t priority;
+            if (!readPod(in, priority) || !by_priority[priority].load(in)) return false;
+        }
+        return true;
+    }
+};
+
+RunMetrics collectMetrics(const std::vector<Process>& processes) {
+    RunMetrics metrics;
     for (const auto& p : processes) {
-        avg_wait += p.waiting_time;
-        avg_turn += p.turnaround_time;
-        total_burst_time += p.burst_time;
+        metrics.add(p);
     }
-    int n = processes.size();
+    return metrics;
+}
+
+void calculateMetrics(const RunMetrics& metrics, SimTime total_time, double& avg_wait, double& avg_turn, double& cpu_util, double& throughput) {
+    avg_wait = metrics.total_waiting;
+    avg_turn = metrics.total_turnaround;
+    size_t n = metrics.completed;
     if (n > 0) {
         avg_wait /= n;
         avg_turn /= n;
     }
-    cpu_util = (total_time > 0) ? (double)total_burst_time / total_time * 100 : 0;
+    cpu_util = (total_time > 0) ? (double)metrics.total_burst / total_time * 100 : 0;
     throughput = (total_time > 0) ? (double)n / total_time : 0;
 }
-void printGantt(std::ostream& out, const std::vector<std::pair<std::string, int>>& gantt) {
-    out << "Gantt Chart: ";
-    for (const auto& entry : gantt) {
-        out << entry.first << " (" << entry.second << ") ";
+void printGantt(ResultWriter& out, const Gantt& gantt, SegmentEncoder& encoder) {
+    if (!gantt.enabled()) return;
+    switch (encoder.outputFormat()) {
+        case OutputFormat::Text:
+            out.put("Gantt Chart: ");
+            gantt.print(out, encoder);
+            out.put('\n');
+            break;
+        case OutputFormat::CSV:
+            out.put("\nprocess,start,length\n");
+            gantt.print(out, encoder);
+            break;
+        case OutputFormat::Binary:
+            gantt.print(out, encoder);
+            break;
+    }
+}
+
+// The binary result stream starts with OUTPUT_MAGIC and a u32 version and a
+// u32 of zero, followed by one-byte-tagged records in native byte order:
+//   RECORD_METRICS  f64 avg_wait, avg_turnaround, cpu_util, throughput;
+//                   i64 total_time; u64 completed, with_deadline, deadline_misses
+//   RECORD_OVERHEAD u64 decisions, switches; f64 switch, warmup and decision
+//                   time, effective total_time, cpu_util, throughput
+//   RECORD_LATENCY  u32 scope (0 all processes, 1 one priority), i32 priority,
+//                   u64 count; f64 P50, P99, P99.9 of waiting, turnaround,
+//                   response and slowdown in that order; f64 mean slowdown,
+//                   Jain fairness
+//   RECORD_NAME     u32 pid, u32 length, name bytes
+//   RECORD_SEGMENT  u32 pid, i64 start, i64 length
+// The metrics record comes first, then the overhead record if the run was
+// charged DispatchCosts, then latency records (all processes, then
+// each priority in ascending order), then names and segments in time order.
+void writeBinaryHeader(ResultWriter& out) {
+    std::uint32_t header[2] = {OUTPUT_VERSION, 0};
+    out.raw(OUTPUT_MAGIC, sizeof(OUTPUT_MAGIC));
+    out.raw(header, sizeof(header));
+}
+
+constexpr double LATENCY_QUANTILES[3] = {0.5, 0.99, 0.999};
+
+void printPercentiles(ResultWriter& out, const char* label, const LatencyHistogram& histogram, double scale = 1) {
+    out.put(label);
+    out.put(" P50/P99/P99.9: ");
+    for (int i = 0; i < 3; ++i) {
+        if (i) out.put(" / ");
+        out.put(histogram.percentile(LATENCY_QUANTILES[i]) / scale);
+    }
+}
+
+void writeLatencyRecord(ResultWriter& out, std::uint32_t scope, std::int32_t priority, const LatencyStats& stats) {
+    double values[14];
+    const LatencyHistogram* histograms[4] = {&stats.waiting, &stats.turnaround, &stats.response, &stats.slowdown};
+    for (int h = 0; h < 4; ++h) {
+        double scale = h == 3 ? LatencyStats::SLOWDOWN_SCALE : 1;
+        for (int i = 0; i < 3; ++i) values[h * 3 + i] = histograms[h]->percentile(LATENCY_QUANTILES[i]) / scale;
+    }
+    values[12] = stats.meanSlowdown();
+    values[13] = stats.fairness();
+    std::uint64_t count = stats.waiting.count();
+    out.put(char(RECORD_LATENCY));
+    out.raw(&scope, sizeof(scope));
+    out.raw(&priority, sizeof(priority));
+    out.raw(&count, sizeof(count));
+    out.raw(values, sizeof(values));
+}
+
+void writeLatencyCSV(ResultWriter& out, const std::string& prefix, const LatencyStats& stats) {
+    static const char* const quantile_names[3] = {"p50", "p99", "p99.9"};
+    const std::pair<const char*, const LatencyHistogram*> histograms[4] = {
+        {"waiting", &stats.waiting}, {"turnaround", &stats.turnaround}, {"response", &stats.response}, {"slowdown", &stats.slowdown}};
+    for (int h = 0; h < 4; ++h) {
+        double scale = h == 3 ? LatencyStats::SLOWDOWN_SCALE : 1;
+        for (int i = 0; i < 3; ++i) {
+            out.put(prefix); out.put(histograms[h].first); out.put('_'); out.put(quantile_names[i]); out.put(',');
+            out.put(histograms[h].second->percentile(LATENCY_QUANTILES[i]) / scale); out.put('\n');
+        }
+    }
+    out.put(prefix); out.put("slowdown_mean,"); out.put(stats.meanSlowdown()); out.put('\n');
+    out.put(prefix); out.put("fairness,"); out.put(stats.fairness()); out.put('\n');
+}
+
+// Tail latencies for the whole run and for each priority class.
+void printLatency(ResultWriter& out, const RunMetrics& metrics, OutputFormat format) {
+    switch (format) {
+        case OutputFormat::Text:
+            printPercentiles(out, "Waiting Time", metrics.latency.waiting); out.put('\n');
+            printPercentiles(out, "Turnaround Time", metrics.latency.turnaround); out.put('\n');
+            printPercentiles(out, "Response Time", metrics.latency.response); out.put('\n');
+            printPercentiles(out, "Slowdown", metrics.latency.slowdown, LatencyStats::SLOWDOWN_SCALE);
+            out.put(" (mean "); out.put(metrics.latency.meanSlowdown());
+            out.put(", fairness "); out.put(metrics.latency.fairness()); out.put(")\n");
+            for (const auto& [priority, stats] : metrics.by_priority) {
+                out.put("Priority "); out.put(priority); out.put(" ("); out.put(stats.waiting.count()); out.put(" processes): ");
+                printPercentiles(out, "Waiting", stats.waiting); out.put(", ");
+                printPercentiles(out, "Response", stats.response); out.put(", ");
+                printPercentiles(out, "Slowdown", stats.slowdown, LatencyStats::SLOWDOWN_SCALE); out.put('\n');
+            }
+            break;
+        case OutputFormat::CSV:
+            writeLatencyCSV(out, "", metrics.latency);
+            for (const auto& [priority, stats] : metrics.by_priority) {
+                std::string prefix = "priority_" + std::to_string(priority) + "_";
+                out.put(prefix); out.put("completed,"); out.put(stats.waiting.count()); out.put('\n');
+                writeLatencyCSV(out, prefix, stats);
+            }
+            break;
+        case OutputFormat::Binary:
+            writeLatencyRecord(out, 0, 0, metrics.latency);
+            for (const auto& [priority, stats] : metrics.by_priority) writeLatencyRecord(out, 1, priority, stats);
+            break;
+    }
+}
+
+// Utilization and throughput over the run stretched by the delay `meter` had
+// left at its end, as calculateMetrics() gives them over the planned run.
+void effectiveMetrics(const RunMetrics& metrics, SimTime total_time, const OverheadMeter& meter, double& effective_time,
+                      double& cpu_util, double& throughput) {
+    effective_time = total_time + meter.delay();
+    cpu_util = effective_time > 0 ? metrics.total_burst / effective_time * 100 : 0;
+    throughput = effective_time > 0 ? metrics.completed / effective_time : 0;
+}
+
+// What dispatch overhead did to the run, as charged by `meter`.
+void printOverhead(ResultWriter& out, const OverheadMeter& meter, const RunMetrics& metrics, SimTime total_time, OutputFormat format) {
+    double effective_time, cpu_util, throughput;
+    effectiveMetrics(metrics, total_time, meter, effective_time, cpu_util, throughput);
+    switch (format) {
+        case OutputFormat::Text:
+            out.put("Context Switches: "); out.put(meter.switchCount());
+            out.put(" in "); out.put(meter.decisionCount()); out.put(" decisions\n");
+            out.put("Scheduling Overhead: "); out.put(meter.overhead());
+            out.put(" (switches "); out.put(meter.switchTime());
+            out.put(", warmup "); out.put(meter.warmupTime());
+            out.put(", decisions "); out.put(meter.decisionTime()); out.put(")\n");
+            out.put("Effective CPU Utilization: "); out.put(cpu_util); out.put("%\n");
+            out.put("Effective Throughput: "); out.put(throughput); out.put(" processes/unit time\n");
+            break;
+        case OutputFormat::CSV:
+            out.put("decisions,"); out.put(meter.decisionCount()); out.put('\n');
+            out.put("context_switches,"); out.put(meter.switchCount()); out.put('\n');
+            out.put("switch_time,"); out.put(meter.switchTime()); out.put('\n');
+            out.put("warmup_time,"); out.put(meter.warmupTime()); out.put('\n');
+            out.put("decision_time,"); out.put(meter.decisionTime()); out.put('\n');
+            out.put("effective_total_time,"); out.put(effective_time); out.put('\n');
+            out.put("effective_cpu_utilization,"); out.put(cpu_util); out.put('\n');
+            out.put("effective_throughput,"); out.put(throughput); out.put('\n');
+            break;
+        case OutputFormat::Binary: {
+            std::uint64_t counts[2] = {meter.decisionCount(), meter.switchCount()};
+            double values[6] = {meter.switchTime(), meter.warmupTime(), meter.decisionTime(), effective_time, cpu_util, throughput};
+            out.put(char(RECORD_OVERHEAD));
+            out.raw(counts, sizeof(counts));
+            out.raw(values, sizeof(values));
+            break;
+        }
     }
-    out << "\n";
 }
 
-void printResults(std::ostream& out, const std::vector<Process>& processes, int total_time, const std::vector<std::pair<std::string, int>>& gantt) {
+// With `percentiles`, the tail latencies follow the summary (see printLatency()).
+void printResults(ResultWriter& out, const RunMetrics& metrics, SimTime total_time, const Gantt& gantt, SegmentEncoder& encoder,
+                  bool percentiles, const OverheadMeter* meter = nullptr) {
     double avg_wait, avg_turn, cpu_util, throughput;
-    calculateMetrics(processes, total_time, avg_wait, avg_turn, cpu_util, throughput);
+    calculateMetrics(metrics, total_time, avg_wait, avg_turn, cpu_util, throughput);
+
+    switch (encoder.outputFormat()) {
+        case OutputFormat::Text:
+            out.put("Average Waiting Time: "); out.put(avg_wait); out.put('\n');
+            out.put("Average Turnaround Time: "); out.put(avg_turn); out.put('\n');
+            out.put("CPU Utilization: "); out.put(cpu_util); out.put("%\n");
+            out.put("Throughput: "); out.put(throughput); out.put(" processes/unit time\n");
+            if (metrics.with_deadline > 0) {
+                out.put("Deadline Misses: "); out.put(metrics.deadline_misses);
+                out.put(" of "); out.put(metrics.with_deadline); out.put('\n');
+            }
+            break;
+        case OutputFormat::CSV:
+            out.put("metric,value\n");
+            out.put("avg_waiting_time,"); out.put(avg_wait); out.put('\n');
+            out.put("avg_turnaround_time,"); out.put(avg_turn); out.put('\n');
+            out.put("cpu_utilization,"); out.put(cpu_util); out.put('\n');
+            out.put("throughput,"); out.put(throughput); out.put('\n');
+            out.put("total_time,"); out.put(total_time); out.put('\n');
+            if (metrics.with_deadline > 0) {
+                out.put("deadline_misses,"); out.put(metrics.deadline_misses); out.put('\n');
+            }
+            break;
+        case OutputFormat::Binary: {
+            writeBinaryHeader(out);
+            double rates[4] = {avg_wait, avg_turn, cpu_util, throughput};
+            std::uint64_t counts[3] = {metrics.completed, metrics.with_deadline, metrics.deadline_misses};
+            out.put(char(RECORD_METRICS));
+            out.raw(rates, sizeof(rates));
+            out.raw(&total_time, sizeof(total_time));
+            out.raw(counts, sizeof(counts));
+            break;
+        }
+    }
+    if (meter) printOverhead(out, *meter, metrics, total_time, encoder.outputFormat());
+    if (percentiles) printLatency(out, metrics, encoder.outputFormat());
+    printGantt(out, gantt, encoder);
+}
+
+// Scratch memory for one scheduler run: queues, heaps and index vectors are
+// carved from a buffer that reset() hands back whole, so repeated runs of a
+// sweep or benchmark stop calling the global allocator once the buffer fits.
+// Blocks freed mid-run go to a pool over the buffer and are reused by the same
+// run. Whatever spilled past the buffer is counted and folded into its size at
+// the next reset, so a run that allocates only on its first pass reaches zero
+// allocations from the second on.
+class RunArena {
+public:
+    explicit RunArena(size_t initial_bytes = 64 << 10) : buffer(initial_bytes) { emplace(); }
+    RunArena(const RunArena&) = delete;
+    RunArena& operator=(const RunArena&) = delete;
+
+    // Releases everything the previous run took and returns the resource for the next one.
+    std::pmr::memory_resource* reset() {
+        pool.reset();
+        monotonic.reset();
+        if (overflow.spilled) {
+            buffer.assign(buffer.size() + overflow.spilled, std::byte{});
+            overflow.spilled = 0;
+        }
+        emplace();
+        return &*pool;
+    }
+
+    std::pmr::memory_resource* resource() { return &*pool; }
+
+private:
+    // Upstream of the buffer: forwards to new/delete and tallies what it hands out.
+    struct Overflow : std::pmr::memory_resource {
+        size_t spilled = 0;
+
+        void* do_allocate(size_t bytes, size_t align) override {
+            spilled += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, align);
+        }
+        void do_deallocate(void* p, size_t bytes, size_t align) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    void emplace() {
+        monotonic.emplace(buffer.data(), buffer.size(), &overflow);
+        pool.emplace(&*monotonic);
+    }
+
+    std::vector<std::byte> buffer;
+    Overflow overflow;
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic;
+    std::optional<std::pmr::unsynchronized_pool_resource> pool;
+};
+
+// Binary min-heap of process indices with a position map, so the key of a queued
+// process can be lowered in place (decrease-key) instead of being pushed twice.
+// Keys live in the Process records; `Less` compares two indices.
+template <typename Less>
+class IndexedMinHeap {
+public:
+    explicit IndexedMinHeap(Less less, std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : heap(memory), pos(memory), less(less) {}
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    int top() const { return heap.front(); }
+    bool contains(int i) const { return i < pos.size() && pos[i] != npos; }
+
+    void push(int i) {
+        if (i >= pos.size()) pos.resize(i + 1, npos);
+        pos[i] = heap.size();
+        heap.push_back(i);
+        siftUp(pos[i]);
+    }
+
+    int pop() {
+        int i = heap.front();
+        pos[i] = npos;
+        int last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            pos[last] = 0;
+            siftDown(0);
+        }
+        return i;
+    }
+
+    // Call after lowering the key of a queued process.
+    void decreaseKey(int i) { siftUp(pos[i]); }
+
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    void place(size_t slot, int i) {
+        heap[slot] = i;
+        pos[i] = slot;
+    }
+
+    void siftUp(size_t slot) {
+        int i = heap[slot];
+        while (slot > 0) {
+            size_t parent = (slot - 1) / 2;
+            if (!less(i, heap[parent])) break;
+            place(slot, heap[parent]);
+            slot = parent;
+        }
+        place(slot, i);
+    }
+
+    void siftDown(size_t slot) {
+        int i = heap[slot];
+        size_t n = heap.size();
+        while (true) {
+            size_t child = 2 * slot + 1;
+            if (child >= n) break;
+            if (child + 1 < n && less(heap[child + 1], heap[child])) child++;
+            if (!less(heap[child], i)) break;
+            place(slot, heap[child]);
+            slot = child;
+        }
+        place(slot, i);
+    }
+
+    std::pmr::vector<int> heap;
+    std::pmr::vector<size_t> pos;
+    Less less;
+};
+
+// Orders ready slots by `key`, then arrival time, then admission order, which is
+// the order a first-match linear scan over an arrival-sorted vector picks them in.
+template <typename Key>
+auto readyOrder(const std::vector<Process>& processes, Key key) {
+    return [&processes, key](int a, int b) {
+        const Process& pa = processes[a];
+        const Process& pb = processes[b];
+        if (key(pa) != key(pb)) return key(pa) < key(pb);
+        if (pa.arrival_time != pb.arrival_time) return pa.arrival_time < pb.arrival_time;
+        return pa.seq < pb.seq;
+    };
+}
 
-    out << "Average Waiting Time: " << avg_wait << "\n";
-    out << "Average Turnaround Time: " << avg_turn << "\n";
-    out << "CPU Utilization: " << cpu_util << "%\n";
-    out << "Throughput: " << throughput << " processes/unit time\n";
-    printGantt(out, gantt);
+// Indices of `processes` in arrival order, used as the admission cursor.
+std::vector<int> arrivalOrder(const std::vector<Process>& processes) {
+    std::vector<int> order(processes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return processes[a].arrival_time < processes[b].arrival_time;
+    });
+    return order;
 }
 
-class Scheduler {
-public:
-    virtual ~Scheduler() = default;
-    virtual void schedule(std::vector<Process>& processes, std::vector<std::pair<std::string, int>>& gantt, int& total_time) = 0;
+// Hierarchical timing wheel of pending events keyed by integer time. Times are
+// held relative to the wheel's start, so events before zero work too. Eleven
+// levels of 64 slots cover the whole 64-bit range: an event sits at the level
+// of the highest 6-bit digit in which its time differs from the wheel's
+// cursor, and a per-level occupancy bitmap finds the next non-empty slot with
+// one find-first-set. Reaching a higher-level slot moves its events down a
+// level or more, so each event is moved at most once per level and insert,
+// pop and cancel are amortized O(1). Events due at the same time pop in order
+// of their `tie` value.
+//
+// Inserted times must not be earlier than the last popped or peeked time.
+class TimerWheel {
+public:
+    using Handle = int;
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    void reserve(size_t n) { nodes.reserve(n); }
+    // Earliest time the wheel will hold; set it before the first insert.
+    void startAt(SimTime time) { origin = time; }
+
+    Handle insert(SimTime time, std::uint64_t tie, int payload) {
+        time -= origin;
+        if (time < cursor) throw std::runtime_error("timer wheel insert before the current time");
+        Handle h;
+        if (free_nodes.empty()) {
+            h = nodes.size();
+            nodes.emplace_back();
+        } else {
+            h = free_nodes.back();
+            free_nodes.pop_back();
+        }
+        nodes[h].time = time;
+        nodes[h].tie = tie;
+        nodes[h].payload = payload;
+        place(h);
+        count++;
+        return h;
+    }
+
+    // Removes a pending event. The handle may be reused by later inserts.
+    void cancel(Handle h) {
+        unlink(h);
+        free_nodes.push_back(h);
+        count--;
+    }
+
+    // Time of the earliest pending event; the wheel must not be empty.
+    SimTime nextTime() {
+        settle();
+        return cursor + origin;
+    }
+
+    int nextPayload() {
+        settle();
+        return nodes[head[0][cursor & mask]].payload;
+    }
+
+    // Removes the earliest pending event and returns its payload.
+    int pop() {
+        settle();
+        Handle h = head[0][cursor & mask];
+        int payload = nodes[h].payload;
+        cancel(h);
+        return payload;
+    }
+
+private:
+    static constexpr int levels = 11;
+    static constexpr int bits = 6;
+    static constexpr std::uint64_t mask = 63;
+
+    struct Node {
+        SimTime time;
+        std::uint64_t tie;
+        int payload;
+        Handle prev, next;
+        int level, slot;
+    };
+
+    static std::uint64_t digit(std::uint64_t t, int level) {
+        return (t >> (bits * level)) & mask;
+    }
+
+    void place(Handle h) {
+        Node& n = nodes[h];
+        std::uint64_t diff = (std::uint64_t)n.time ^ (std::uint64_t)cursor;
+        n.level = diff == 0 ? 0 : (63 - __builtin_clzll(diff)) / bits;
+        n.slot = digit(n.time, n.level);
+        Handle& first = head[n.level][n.slot];
+        Handle& last = tail[n.level][n.slot];
+        // Level-0 slots hold a single time and stay sorted by tie; scan from
+        // the back, since ties usually arrive in order.
+        Handle after = last;
+        if (n.level == 0) {
+            while (after != -1 && nodes[after].tie > n.tie) after = nodes[after].prev;
+        }
+        n.prev = after;
+        n.next = after == -1 ? first : nodes[after].next;
+        if (n.prev == -1) first = h; else nodes[n.prev].next = h;
+        if (n.next == -1) last = h; else nodes[n.next].prev = h;
+        occupied[n.level] |= 1ull << n.slot;
+    }
+
+    void unlink(Handle h) {
+        Node& n = nodes[h];
+        if (n.prev == -1) head[n.level][n.slot] = n.next; else nodes[n.prev].next = n.next;
+        if (n.next == -1) tail[n.level][n.slot] = n.prev; else nodes[n.next].prev = n.prev;
+        if (head[n.level][n.slot] == -1) occupied[n.level] &= ~(1ull << n.slot);
+    }
+
+    // Moves the cursor to the earliest pending time, cascading higher-level
+    // slots down until that time's events sit in a level-0 slot.
+    void settle() {
+        while (true) {
+            std::uint64_t due = occupied[0] & (~0ull << digit(cursor, 0));
+            if (due) {
+                cursor = (cursor & ~(SimTime)mask) | __builtin_ctzll(due);
+                return;
+            }
+            int level = 1;
+            std::uint64_t later = 0;
+            for (; level < levels; ++level) {
+                later = occupied[level] & (~0ull << digit(cursor, level));
+                if (later) break;
+            }
+            if (level == levels) return;
+            int slot = __builtin_ctzll(later);
+            int shift = bits * (level + 1);
+            std::uint64_t high = shift >= 64 ? 0 : ((std::uint64_t)cursor >> shift) << shift;
+            cursor = high | ((std::uint64_t)slot << (bits * level));
+
+            Handle h = head[level][slot];
+            head[level][slot] = tail[level][slot] = -1;
+            occupied[level] &= ~(1ull << slot);
+            while (h != -1) {
+                Handle next = nodes[h].next;
+                place(h);
+                h = next;
+            }
+        }
+    }
+
+    std::pmr::vector<Node> nodes;
+    std::pmr::vector<Handle> free_nodes;
+    Handle head[levels][64];
+    Handle tail[levels][64];
+    std::uint64_t occupied[levels] = {};
+    SimTime origin = 0;
+    SimTime cursor = 0;  // relative to origin
+    size_t count = 0;
+
+public:
+    explicit TimerWheel(std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : nodes(memory), free_nodes(memory) {
+        std::fill(&head[0][0], &head[0][0] + levels * 64, -1);
+        std::fill(&tail[0][0], &tail[0][0] + levels * 64, -1);
+    }
+};
+
+// Where a scheduler's processes come from, handed out in arrival order.
+// Schedulers refer to admitted processes by slot; a slot stays valid until its
+// process is retired and may then be reused for a later arrival. admit() can
+// grow the storage, so references into it must not be held across admissions.
+class ProcessFeed {
+public:
+    virtual ~ProcessFeed() = default;
+
+    virtual bool hasNext() const = 0;
+    // Arrival time of the process the next admit() returns.
+    virtual SimTime nextArrival() const = 0;
+    // Brings the next arrival in, ready to run, and returns its slot.
+    virtual int admit() = 0;
+    // Called once the process in `slot` has finished.
+    virtual void retire(int slot) = 0;
+
+    Process& operator[](int slot) { return (*slots)[slot]; }
+    const std::vector<Process>& storage() const { return *slots; }
+
+    // Simulated time the run starts at: zero, or the snapshot time on a resume.
+    SimTime startTime() const { return start_time; }
+    // Schedulers check this before each decision and return once it holds,
+    // leaving unfinished processes in their slots for a snapshot.
+    bool suspended(SimTime now) const { return now >= stop_time; }
+    SimTime stopTime() const { return stop_time; }
+    // Where a run draws its queues and heaps from.
+    std::pmr::memory_resource* memory() const { return run_memory; }
+
+protected:
+    static void prepare(Process& p, std::uint64_t seq) {
+        p.remaining_time = p.burst_time;
+        p.vruntime = 0;
+        p.response_time = -1;
+        p.seq = seq;
+        p.finished = false;
+    }
+
+    std::vector<Process>* slots = nullptr;
+    SimTime start_time = 0;
+    SimTime stop_time = std::numeric_limits<SimTime>::max();
+    std::pmr::memory_resource* run_memory = std::pmr::get_default_resource();
+};
+
+// Feeds a fully loaded workload; slots are indices into the caller's vector and
+// results stay in it after the run. Arrivals wait in a timer wheel, tied by
+// index, so the vector needn't be sorted.
+class VectorFeed final : public ProcessFeed {
+public:
+    explicit VectorFeed(std::vector<Process>& processes, std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : arrivals(memory) {
+        slots = &processes;
+        run_memory = memory;
+        arrivals.reserve(processes.size());
+        SimTime first = 0;
+        for (const Process& p : processes) first = std::min(first, p.arrival_time);
+        arrivals.startAt(first);
+        for (size_t i = 0; i < processes.size(); ++i) {
+            arrivals.insert(processes[i].arrival_time, i, i);
+        }
+    }
+
+    bool hasNext() const override { return !arrivals.empty(); }
+    SimTime nextArrival() const override { return arrivals.nextTime(); }
+    int admit() override {
+        int slot = arrivals.pop();
+        prepare((*slots)[slot], admitted++);
+        return slot;
+    }
+    void retire(int) override {}
+
+private:
+    // Peeking settles the wheel, which doesn't change what it holds.
+    mutable TimerWheel arrivals;
+    std::uint64_t admitted = 0;
+};
+
+// One trace record at a time, in file order.
+class TraceReader {
+public:
+    virtual ~TraceReader() = default;
+    // Fills `id` and the arrival, burst, priority and deadline of `p`; false at end of trace.
+    virtual bool next(std::string& id, Process& p) = 0;
+};
+
+// The whitespace text format: one "id arrival burst priority" record per line.
+class TextTraceReader : public TraceReader {
+public:
+    explicit TextTraceReader(std::istream& in) : in(in) {}
+
+    bool next(std::string& id, Process& p) override {
+        SimTime at, bt;
+        int pri;
+        if (!(in >> id >> at >> bt >> pri)) return false;
+        p = Process{0, at, bt, pri};
+        return true;
+    }
+
+private:
+    std::istream& in;
+};
+
+// Binary trace format, version 1, in native (little-endian) byte order:
+//
+//   TraceHeader
+//   int64  arrival[count], burst[count], deadline[count]
+//   int32  priority[count]
+//   uint32 name[count]                  index into the name table
+//   uint64 name_offset[name_count + 1]  byte ranges of the names in the pool
+//   char   pool[pool_bytes]
+//
+// Every column starts 8-byte aligned, so a mapped file is read in place.
+constexpr char TRACE_MAGIC[8] = {'S', 'C', 'H', 'E', 'D', 'T', 'R', 'C'};
+constexpr std::uint32_t TRACE_VERSION = 1;
+constexpr std::uint32_t TRACE_ARRIVAL_SORTED = 1;
+
+struct TraceHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t flags;
+    std::uint64_t count;
+    std::uint64_t name_count;
+    std::uint64_t pool_bytes;
+};
+
+size_t traceFileSize(const TraceHeader& h) {
+    return sizeof(TraceHeader) + h.count * (3 * sizeof(SimTime) + 2 * sizeof(std::uint32_t)) +
+           (h.name_count + 1) * sizeof(std::uint64_t) + h.pool_bytes;
+}
+
+bool isBinaryTrace(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(TRACE_MAGIC)];
+    return file.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), TRACE_MAGIC);
+}
+
+// A binary trace mapped read-only; the columns point straight into the mapping.
+class MappedTrace {
+public:
+    explicit MappedTrace(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot open " + filename);
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(TraceHeader)) {
+            ::close(fd);
+            throw std::runtime_error(filename + " is too short to be a binary trace");
+        }
+        length = st.st_size;
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) throw std::runtime_error("cannot map " + filename);
+        base = static_cast<const char*>(mapped);
+        ::madvise(mapped, length, MADV_SEQUENTIAL);
+
+        header = reinterpret_cast<const TraceHeader*>(base);
+        if (header->version != TRACE_VERSION) {
+            ::munmap(mapped, length);
+            throw std::runtime_error(filename + " has unsupported trace version " + std::to_string(header->version));
+        }
+        if (traceFileSize(*header) != length) {
+            ::munmap(mapped, length);
+            throw std::runtime_error(filename + " is truncated or corrupt");
+        }
+        const char* column = base + sizeof(TraceHeader);
+        arrival = reinterpret_cast<const SimTime*>(column);
+        burst = arrival + header->count;
+        deadline = burst + header->count;
+        priority = reinterpret_cast<const std::int32_t*>(deadline + header->count);
+        name = reinterpret_cast<const std::uint32_t*>(priority + header->count);
+        name_offset = reinterpret_cast<const std::uint64_t*>(name + header->count);
+        pool = reinterpret_cast<const char*>(name_offset + header->name_count + 1);
+    }
+
+    ~MappedTrace() { ::munmap(const_cast<char*>(base), length); }
+    MappedTrace(const MappedTrace&) = delete;
+    MappedTrace& operator=(const MappedTrace&) = delete;
+
+    size_t size() const { return header->count; }
+    size_t nameCount() const { return header->name_count; }
+    bool arrivalSorted() const { return header->flags & TRACE_ARRIVAL_SORTED; }
+
+    std::string nameOf(size_t n) const { return std::string(pool + name_offset[n], pool + name_offset[n + 1]); }
+    Process process(size_t row) const {
+        Process p{name[row], arrival[row], burst[row], priority[row]};
+        p.deadline = deadline[row];
+        return p;
+    }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    const TraceHeader* header = nullptr;
+    const SimTime* arrival = nullptr;
+    const SimTime* burst = nullptr;
+    const SimTime* deadline = nullptr;
+    const std::int32_t* priority = nullptr;
+    const std::uint32_t* name = nullptr;
+    const std::uint64_t* name_offset = nullptr;
+    const char* pool = nullptr;
+};
+
+class BinaryTraceReader : public TraceReader {
+public:
+    explicit BinaryTraceReader(const MappedTrace& trace) : trace(trace) {}
+
+    bool next(std::string& id, Process& p) override {
+        if (row == trace.size()) return false;
+        p = trace.process(row++);
+        id = trace.nameOf(p.pid);
+        return true;
+    }
+
+private:
+    const MappedTrace& trace;
+    size_t row = 0;
+};
+
+// Writes `processes` as a binary trace, sorted by arrival time.
+bool writeBinaryTrace(const std::string& filename, std::vector<Process> processes, const ProcessNames& names) {
+    std::stable_sort(processes.begin(), processes.end(), [](const Process& a, const Process& b) {
+        return a.arrival_time < b.arrival_time;
+    });
+    std::vector<std::uint64_t> name_offset{0};
+    for (size_t n = 0; n < names.size(); ++n) {
+        name_offset.push_back(name_offset.back() + names.name(n).size());
+    }
+
+    TraceHeader header{};
+    std::copy(TRACE_MAGIC, TRACE_MAGIC + sizeof(TRACE_MAGIC), header.magic);
+    header.version = TRACE_VERSION;
+    header.flags = TRACE_ARRIVAL_SORTED;
+    header.count = processes.size();
+    header.name_count = names.size();
+    header.pool_bytes = name_offset.back();
+
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) return false;
+    auto write = [&out](const void* data, size_t bytes) { out.write(static_cast<const char*>(data), bytes); };
+    auto writeColumn = [&](auto field) {
+        using T = decltype(field(processes[0]));
+        std::vector<T> column;
+        column.reserve(processes.size());
+        for (const auto& p : processes) column.push_back(field(p));
+        write(column.data(), column.size() * sizeof(T));
+    };
+    write(&header, sizeof(header));
+    writeColumn([](const Process& p) { return (SimTime)p.arrival_time; });
+    writeColumn([](const Process& p) { return (SimTime)p.burst_time; });
+    writeColumn([](const Process& p) { return (SimTime)p.deadline; });
+    writeColumn([](const Process& p) { return (std::int32_t)p.priority; });
+    writeColumn([](const Process& p) { return (std::uint32_t)p.pid; });
+    write(name_offset.data(), name_offset.size() * sizeof(std::uint64_t));
+    for (size_t n = 0; n < names.size(); ++n) {
+        write(names.name(n).data(), names.name(n).size());
+    }
+    return static_cast<bool>(out);
+}
+
+// Reads an arrival-sorted trace lazily, one record ahead of the scheduler,
+// so memory follows the number of live processes instead of the trace length.
+// Finished processes are folded into `metrics` and their slots recycled; a
+// slot doubles as the pid, so the Gantt chart is sealed before each reuse.
+// Input that goes back in time is rejected rather than scheduled wrongly.
+class TraceStreamFeed : public ProcessFeed {
+public:
+    TraceStreamFeed(TraceReader& reader, Gantt& gantt, RunMetrics& metrics) : reader(reader), gantt(gantt), metrics(metrics) {
+        slots = &pool;
+        readNext();
+    }
+
+    bool hasNext() const override { return has_next; }
+    SimTime nextArrival() const override { return next.arrival_time; }
+
+    int admit() override {
+        int slot;
+        if (free_slots.empty()) {
+            slot = pool.size();
+            pool.push_back(next);
+        } else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+            pool[slot] = next;
+        }
+        pool[slot].pid = slot;
+        names.assign(slot, next_id);
+        prepare(pool[slot], admitted++);
+        readNext();
+        return slot;
+    }
+
+    void retire(int slot) override {
+        gantt.seal();
+        gantt.release(pool[slot].pid);
+        metrics.add(pool[slot]);
+        free_slots.push_back(slot);
+    }
+
+    const ProcessNames& slotNames() const { return names; }
+
+private:
+    void readNext() {
+        has_next = reader.next(next_id, next);
+        if (!has_next) return;
+        if (admitted > 0 && next.arrival_time < last_arrival) {
+            throw std::runtime_error("trace is not sorted by arrival time (" + next_id + " arrives at " +
+                                     std::to_string(next.arrival_time) + " after " + std::to_string(last_arrival) + ")");
+        }
+        last_arrival = next.arrival_time;
+    }
+
+    TraceReader& reader;
+    Gantt& gantt;
+    RunMetrics& metrics;
+    std::vector<Process> pool;
+    std::vector<int> free_slots;
+    ProcessNames names;
+    Process next{};
+    std::string next_id;
+    bool has_next = false;
+    SimTime last_arrival = 0;
+    std::uint64_t admitted = 0;
+};
+
+// State of a run at one point in simulated time, in a form any policy can
+// resume from: the processes admitted but not finished (remaining time,
+// response time and admission order intact), how far the workload's arrival
+// order has been admitted, the partial metrics and the Gantt chart so far.
+// The workload itself isn't copied; a snapshot is only meaningful against the
+// workload it was taken from, which fingerprint() identifies on disk.
+//
+// Resuming re-admits the live processes in admission order. Policies whose
+// ready order is a function of the processes (FCFS, SJF, SRTF, Priority,
+// EDF) carry on exactly as if never stopped; the others restart their own
+// bookkeeping (RR and MLQ queue order, MLFQ levels, lottery compensation and
+// random stream, CFS vruntimes) from the live set.
+struct SimSnapshot {
+    SimTime time = 0;
+    size_t cursor = 0;
+    std::uint64_t admitted = 0;
+    std::vector<Process> live;
+    RunMetrics metrics;
+    std::vector<GanttChunk> gantt;
+    std::vector<GanttSegment> gantt_tail;
+
+    bool save(const std::string& filename, std::uint64_t fingerprint) const;
+    // Fails on a file that isn't a whole, consistent snapshot of `workload`.
+    bool load(const std::string& filename, const std::vector<Process>& workload);
+};
+
+// FNV-1a over the fields a run reads, to reject a snapshot loaded against a
+// different workload.
+std::uint64_t workloadFingerprint(const std::vector<Process>& workload) {
+    std::uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](std::uint64_t value) {
+        for (int byte = 0; byte < 8; ++byte) {
+            hash ^= (value >> (byte * 8)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(workload.size());
+    for (const auto& p : workload) {
+        mix(p.pid);
+        mix(p.arrival_time);
+        mix(p.burst_time);
+        mix(p.priority);
+        mix(p.deadline);
+    }
+    return hash;
+}
+
+// Snapshot file, native byte order: SNAPSHOT_MAGIC, u32 version, u32 zero,
+// u64 workload fingerprint, i64 time, u64 cursor, u64 admitted, u64 live
+// count and the live process records, the metrics, then u64 segment count
+// and the segments (tail last) with a u8 saying whether there is a tail.
+// A process record is its fields in declaration order, u32 pid and i32
+// priority, without `finished` and without padding.
+constexpr char SNAPSHOT_MAGIC[8] = {'S', 'C', 'H', 'E', 'D', 'S', 'N', 'P'};
+constexpr std::uint32_t SNAPSHOT_VERSION = 2;
+constexpr size_t SNAPSHOT_PROCESS_BYTES = 2 * sizeof(std::uint32_t) + 9 * sizeof(SimTime);
+
+void writeProcess(std::ostream& out, const Process& p) {
+    writePod(out, p.pid);
+    writePod(out, p.arrival_time);
+    writePod(out, p.burst_time);
+    writePod(out, std::int32_t(p.priority));
+    writePod(out, p.remaining_time);
+    writePod(out, p.waiting_time);
+    writePod(out, p.turnaround_time);
+    writePod(out, p.deadline);
+    writePod(out, p.vruntime);
+    writePod(out, p.response_time);
+    writePod(out, p.seq);
+}
+
+bool readProcess(std::istream& in, Process& p) {
+    std::int32_t priority;
+    if (!readPod(in, p.pid) || !readPod(in, p.arrival_time) || !readPod(in, p.burst_time) || !readPod(in, priority) ||
+        !readPod(in, p.remaining_time) || !readPod(in, p.waiting_time) || !readPod(in, p.turnaround_time) ||
+        !readPod(in, p.deadline) || !readPod(in, p.vruntime) || !readPod(in, p.response_time) || !readPod(in, p.seq)) {
+        return false;
+    }
+    p.priority = priority;
+    p.finished = false;
+    return true;
+}
+
+// Bytes between the read position and the end of `in`, to bound counts read
+// from a file before allocating for them.
+std::uint64_t bytesLeft(std::istream& in) {
+    std::istream::pos_type here = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::istream::pos_type end = in.tellg();
+    in.seekg(here);
+    return in && end >= here ? std::uint64_t(end - here) : 0;
+}
+
+bool SimSnapshot::save(const std::string& filename, std::uint64_t fingerprint) const {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) return false;
+    out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writePod(out, SNAPSHOT_VERSION);
+    writePod(out, std::uint32_t(0));
+    writePod(out, fingerprint);
+    writePod(out, time);
+    writePod(out, (std::uint64_t)cursor);
+    writePod(out, admitted);
+    writePod(out, (std::uint64_t)live.size());
+    for (const auto& p : live) writeProcess(out, p);
+    metrics.save(out);
+    std::uint64_t segments = gantt_tail.size();
+    for (const auto& chunk : gantt) segments += chunk->size();
+    writePod(out, segments);
+    for (const auto& chunk : gantt) {
+        out.write(reinterpret_cast<const char*>(chunk->data()), chunk->size() * sizeof(GanttSegment));
+    }
+    out.write(reinterpret_cast<const char*>(gantt_tail.data()), gantt_tail.size() * sizeof(GanttSegment));
+    writePod(out, std::uint8_t(!gantt_tail.empty()));
+    return static_cast<bool>(out);
+}
+
+bool SimSnapshot::load(const std::string& filename, const std::vector<Process>& workload) {
+    std::ifstream in(filename, std::ios::binary);
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    std::uint32_t version, reserved;
+    std::uint64_t stored_fingerprint, stored_cursor, live_count, segments;
+    std::uint8_t has_tail;
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), SNAPSHOT_MAGIC) ||
+        !readPod(in, version) || version != SNAPSHOT_VERSION || !readPod(in, reserved) || reserved != 0 ||
+        !readPod(in, stored_fingerprint) || stored_fingerprint != workloadFingerprint(workload) ||
+        !readPod(in, time) || !readPod(in, stored_cursor) || stored_cursor > workload.size() ||
+        !readPod(in, admitted) || !readPod(in, live_count) || live_count > admitted ||
+        live_count > bytesLeft(in) / SNAPSHOT_PROCESS_BYTES) {
+        return false;
+    }
+    std::uint32_t pid_end = 0;
+    for (const auto& p : workload) pid_end = std::max(pid_end, p.pid + 1);
+    cursor = stored_cursor;
+    live.resize(live_count);
+    for (auto& p : live) {
+        if (!readProcess(in, p) || p.pid >= pid_end || p.seq >= admitted || p.remaining_time <= 0) return false;
+    }
+    if (!metrics.load(in) || !readPod(in, segments) || segments > bytesLeft(in) / sizeof(GanttSegment)) return false;
+    std::vector<GanttSegment> chart(segments);
+    if (!in.read(reinterpret_cast<char*>(chart.data()), segments * sizeof(GanttSegment))) return false;
+    if (!readPod(in, has_tail) || has_tail > 1 || !Gantt::wellFormed(chart.data(), chart.data() + chart.size(), pid_end, has_tail) ||
+        in.peek() != std::char_traits<char>::eof()) {
+        return false;
+    }
+    gantt_tail.clear();
+    if (has_tail) {
+        gantt_tail.push_back(chart.back());
+        chart.pop_back();
+    }
+    gantt.clear();
+    if (!chart.empty()) gantt.push_back(std::make_shared<const std::vector<GanttSegment>>(std::move(chart)));
+    return true;
+}
+
+// Feeds a loaded workload from a snapshot onwards: first the snapshot's live
+// processes, as they were, then the rest of `order` from its cursor. Every
+// branch forked from one snapshot reads the same workload and chart prefix
+// and copies only the processes it admits into its own slots, so a fork costs
+// the live set and the metrics, not the prefix. Finished processes are folded
+// into `metrics`, which starts from the snapshot's. The run stops at the
+// first decision at or after `stop`, ready for snapshot().
+class BranchFeed : public ProcessFeed {
+public:
+    BranchFeed(const std::vector<Process>& workload, const std::vector<int>& order, const SimSnapshot& from, SimTime stop,
+               Gantt& gantt, RunMetrics& metrics)
+        : workload(workload), order(order), resumed(from.live), cursor(from.cursor), admitted(from.admitted), metrics(metrics) {
+        slots = &pool;
+        start_time = from.time;
+        stop_time = stop;
+        metrics = from.metrics;
+        gantt.restore(from.gantt, from.gantt_tail);
+    }
+
+    bool hasNext() const override { return next_resumed < resumed.size() || cursor < order.size(); }
+    SimTime nextArrival() const override {
+        return next_resumed < resumed.size() ? resumed[next_resumed].arrival_time : workload[order[cursor]].arrival_time;
+    }
+
+    int admit() override {
+        int slot;
+        if (free_slots.empty()) {
+            slot = pool.size();
+            pool.emplace_back();
+            live.push_back(false);
+        } else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+        }
+        if (next_resumed < resumed.size()) {
+            pool[slot] = resumed[next_resumed++];
+        } else {
+            pool[slot] = workload[order[cursor++]];
+            prepare(pool[slot], admitted++);
+        }
+        live[slot] = true;
+        return slot;
+    }
+
+    void retire(int slot) override {
+        metrics.add(pool[slot]);
+        live[slot] = false;
+        free_slots.push_back(slot);
+    }
+
+    // The state of a run that stopped at `time`.
+    SimSnapshot snapshot(const Gantt& gantt, SimTime time) const {
+        SimSnapshot next;
+        next.time = time;
+        next.cursor = cursor;
+        next.admitted = admitted;
+        for (size_t slot = 0; slot < pool.size(); ++slot) {
+            if (live[slot]) next.live.push_back(pool[slot]);
+        }
+        next.live.insert(next.live.end(), resumed.begin() + next_resumed, resumed.end());
+        std::sort(next.live.begin(), next.live.end(), [](const Process& a, const Process& b) { return a.seq < b.seq; });
+        next.metrics = metrics;
+        next.gantt = gantt.freeze(next.gantt_tail);
+        return next;
+    }
+
+private:
+    const std::vector<Process>& workload;
+    const std::vector<int>& order;
+    const std::vector<Process>& resumed;
+    size_t next_resumed = 0;
+    size_t cursor;
+    std::uint64_t admitted;
+    RunMetrics& metrics;
+    std::vector<Process> pool;
+    std::vector<bool> live;
+    std::vector<int> free_slots;
+};
+
+// Struct-of-arrays copy of a workload in arrival order, so selection loops
+// stream only the columns they test instead of whole Process records. Every key
+// column is 64 bits wide so one selection kernel serves all of them.
+struct ProcessTable {
+    std::pmr::vector<int> source;  // row -> index into the original processes vector
+    std::pmr::vector<std::uint32_t> pid;
+    std::pmr::vector<SimTime> arrival;
+    std::pmr::vector<SimTime> burst;
+    std::pmr::vector<SimTime> remaining;
+    std::pmr::vector<SimTime> priority;
+    std::pmr::vector<SimTime> deadline;
+
+    // Rows are sorted by (arrival, index), the order a stable sort by arrival
+    // gives, without stable_sort's temporary buffer.
+    ProcessTable(const std::vector<Process>& processes, std::pmr::memory_resource* memory)
+        : source(processes.size(), memory), pid(memory), arrival(memory), burst(memory),
+          remaining(memory), priority(memory), deadline(memory) {
+        std::iota(source.begin(), source.end(), 0);
+        std::sort(source.begin(), source.end(), [&](int a, int b) {
+            if (processes[a].arrival_time != processes[b].arrival_time) return processes[a].arrival_time < processes[b].arrival_time;
+            return a < b;
+        });
+        pid.reserve(source.size());
+        arrival.reserve(source.size());
+        burst.reserve(source.size());
+        remaining.reserve(source.size());
+        priority.reserve(source.size());
+        deadline.reserve(source.size());
+        for (int i : source) {
+            const Process& p = processes[i];
+            pid.push_back(p.pid);
+            arrival.push_back(p.arrival_time);
+            burst.push_back(p.burst_time);
+            remaining.push_back(p.burst_time);
+            priority.push_back(p.priority);
+            deadline.push_back(p.deadline);
+        }
+    }
+
+    size_t size() const { return source.size(); }
+};
+
+// Masked argmin over rows [begin, end): the row with the smallest key among those
+// that have arrived by `now` and aren't finished (remaining time not negative),
+// lowest row on ties, or -1.
+int maskedArgminScalar(const SimTime* arrival, const SimTime* remaining, const SimTime* key, size_t begin, size_t end, SimTime now) {
+    int best_row = -1;
+    SimTime best = std::numeric_limits<SimTime>::max();
+    for (size_t i = begin; i < end; ++i) {
+        if (arrival[i] <= now && remaining[i] >= 0 && key[i] < best) {
+            best = key[i];
+            best_row = i;
+        }
+    }
+    return best_row;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// Each lane keeps its own running minimum and the first row that reached it;
+// the lanes are then reduced by key and row so the result matches the scalar scan.
+__attribute__((target("avx2")))
+int maskedArgminAVX2(const SimTime* arrival, const SimTime* remaining, const SimTime* key, size_t begin, size_t end, SimTime now) {
+    const __m256i vnow = _mm256_set1_epi64x(now);
+    const __m256i finished = _mm256_set1_epi64x(-1);
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256i best = _mm256_set1_epi64x(std::numeric_limits<SimTime>::max());
+    __m256i best_row = _mm256_set1_epi64x(-1);
+    __m256i row = _mm256_setr_epi64x(begin, begin + 1, begin + 2, begin + 3);
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(arrival + i));
+        __m256i r = _mm256_loadu_si256((const __m256i*)(remaining + i));
+        __m256i k = _mm256_loadu_si256((const __m256i*)(key + i));
+        __m256i eligible = _mm256_andnot_si256(_mm256_cmpgt_epi64(a, vnow), _mm256_cmpgt_epi64(r, finished));
+        __m256i better = _mm256_and_si256(eligible, _mm256_cmpgt_epi64(best, k));
+        best = _mm256_blendv_epi8(best, k, better);
+        best_row = _mm256_blendv_epi8(best_row, row, better);
+        row = _mm256_add_epi64(row, step);
+    }
+    alignas(32) SimTime lane_best[4];
+    alignas(32) SimTime lane_row[4];
+    _mm256_store_si256((__m256i*)lane_best, best);
+    _mm256_store_si256((__m256i*)lane_row, best_row);
+    int result = maskedArgminScalar(arrival, remaining, key, i, end, now);
+    SimTime result_key = result == -1 ? std::numeric_limits<SimTime>::max() : key[result];
+    for (int lane = 0; lane < 4; ++lane) {
+        if (lane_row[lane] == -1) continue;
+        if (result == -1 || lane_best[lane] < result_key || (lane_best[lane] == result_key && lane_row[lane] < result)) {
+            result = lane_row[lane];
+            result_key = lane_best[lane];
+        }
+    }
+    return result;
+}
+
+__attribute__((target("sse4.2")))
+int maskedArgminSSE42(const SimTime* arrival, const SimTime* remaining, const SimTime* key, size_t begin, size_t end, SimTime now) {
+    const __m128i vnow = _mm_set1_epi64x(now);
+    const __m128i finished = _mm_set1_epi64x(-1);
+    const __m128i step = _mm_set1_epi64x(2);
+    __m128i best = _mm_set1_epi64x(std::numeric_limits<SimTime>::max());
+    __m128i best_row = _mm_set1_epi64x(-1);
+    __m128i row = _mm_set_epi64x(begin + 1, begin);
+    size_t i = begin;
+    for (; i + 2 <= end; i += 2) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(arrival + i));
+        __m128i r = _mm_loadu_si128((const __m128i*)(remaining + i));
+        __m128i k = _mm_loadu_si128((const __m128i*)(key + i));
+        __m128i eligible = _mm_andnot_si128(_mm_cmpgt_epi64(a, vnow), _mm_cmpgt_epi64(r, finished));
+        __m128i better = _mm_and_si128(eligible, _mm_cmpgt_epi64(best, k));
+        best = _mm_blendv_epi8(best, k, better);
+        best_row = _mm_blendv_epi8(best_row, row, better);
+        row = _mm_add_epi64(row, step);
+    }
+    alignas(16) SimTime lane_best[2];
+    alignas(16) SimTime lane_row[2];
+    _mm_store_si128((__m128i*)lane_best, best);
+    _mm_store_si128((__m128i*)lane_row, best_row);
+    int result = maskedArgminScalar(arrival, remaining, key, i, end, now);
+    SimTime result_key = result == -1 ? std::numeric_limits<SimTime>::max() : key[result];
+    for (int lane = 0; lane < 2; ++lane) {
+        if (lane_row[lane] == -1) continue;
+        if (result == -1 || lane_best[lane] < result_key || (lane_best[lane] == result_key && lane_row[lane] < result)) {
+            result = lane_row[lane];
+            result_key = lane_best[lane];
+        }
+    }
+    return result;
+}
+#endif
+
+using MaskedArgminFn = int (*)(const SimTime*, const SimTime*, const SimTime*, size_t, size_t, SimTime);
+
+// Picks the widest kernel the running CPU supports, once.
+MaskedArgminFn maskedArgmin() {
+#if defined(__x86_64__) && defined(__GNUC__)
+    static const MaskedArgminFn fn = __builtin_cpu_supports("avx2") ? maskedArgminAVX2
+                                   : __builtin_cpu_supports("sse4.2") ? maskedArgminSSE42
+                                   : maskedArgminScalar;
+    return fn;
+#else
+    return maskedArgminScalar;
+#endif
+}
+
+// Which column of the ProcessTable a scan policy minimizes.
+enum class ScanKey { Burst, Remaining, Priority };
+
+// Linear-scan counterpart of the heap policies, for ready sets too small for a
+// heap to pay off. Rows before `first_live` are finished and rows from
+// `next_arrival` on have not arrived, so each decision scans only the window
+// between them. Non-preemptive policies run the pick to completion; preemptive
+// ones stop at the next arrival and rescan. A finished row's remaining time is
+// set to -1 rather than left at 0, so a process with no burst is still picked,
+// in key order, and completes like any other. It runs a whole workload from
+// time 0; runs over other feeds scan through a ScanQueue instead.
+void scheduleByScan(std::vector<Process>& processes, Gantt& gantt, SimTime& total_time, ScanKey key_column, bool preemptive,
+                    std::pmr::memory_resource* memory) {
+    ProcessTable table(processes, memory);
+    const SimTime* key = key_column == ScanKey::Burst ? table.burst.data()
+                       : key_column == ScanKey::Remaining ? table.remaining.data()
+                       : table.priority.data();
+    MaskedArgminFn argmin = maskedArgmin();
+
+    SimTime current_time = 0;
+    size_t next_arrival = 0;
+    size_t first_live = 0;
+    size_t completed = 0;
+    while(completed < table.size()){
+        while(next_arrival < table.size() && table.arrival[next_arrival] <= current_time) next_arrival++;
+        while(first_live < next_arrival && table.remaining[first_live] < 0) first_live++;
+
+        int row = argmin(table.arrival.data(), table.remaining.data(), key, first_live, next_arrival, current_time);
+        if(row == -1){
+            if(next_arrival == table.size()) break;
+            current_time = table.arrival[next_arrival];
+            continue;
+        }
+
+        SimTime run_time = table.remaining[row];
+        if(preemptive && next_arrival < table.size()){
+            run_time = std::min(run_time, table.arrival[next_arrival] - current_time);
+        }
+        if(table.remaining[row] == table.burst[row]){
+            processes[table.source[row]].response_time = current_time - table.arrival[row];
+        }
+        gantt.append(table.pid[row], current_time, run_time, next_arrival - first_live);
+        table.remaining[row] -= run_time;
+        current_time += run_time;
+
+        if(table.remaining[row] == 0){
+            table.remaining[row] = -1;
+            Process& p = processes[table.source[row]];
+            p.remaining_time = 0;
+            p.turnaround_time = current_time - p.arrival_time;
+            p.waiting_time = p.turnaround_time - p.burst_time;
+            completed++;
+        }
+    }
+    total_time = current_time;
+}
+
+// How the SJF, SRTF and Priority schedulers find their next process.
+enum class ReadySelect { Heap, Scan };
+
+// How each CPU orders its own run queue when a policy runs on several CPUs.
+struct SMPPolicy {
+    enum class Key { Arrival, Burst, Remaining, Priority, Deadline, Enqueue };
+    Key key = Key::Arrival;
+    bool preemptive = false;  // a queued task with a smaller key preempts the running one
+    SimTime quantum = 0;      // 0 runs each dispatch to completion
+};
+
+class Scheduler {
+public:
+    virtual ~Scheduler() = default;
+    // Describes this policy's per-CPU behavior for SMP runs; false if it has none.
+    virtual bool smpPolicy(SMPPolicy&) const { return false; }
+    // `memory` backs the run's queues and heaps; pass a RunArena's to reuse it across runs.
+    virtual void schedule(std::vector<Process>& processes, Gantt& gantt, SimTime& total_time,
+                          std::pmr::memory_resource* memory = std::pmr::get_default_resource()) {
+        VectorFeed feed(processes, memory);
+        run(feed, gantt, total_time);
+    }
+    // Schedules processes as `feed` admits them, until it runs dry.
+    virtual void run(ProcessFeed& feed, Gantt& gantt, SimTime& total_time) = 0;
+};
+
+// Policy-based engine for the single-queue policies. One admit, dispatch and
+// complete loop serves all of them; what differs is plugged in at compile time,
+// so key comparisons and slice checks inline into the loop:
+//
+//   ReadyQueue  which admitted process runs next: FifoQueue or KeyedQueue<Key>
+//   Preemption  whether an arrival cuts the running slice short
+//   TimeSlice   how much of its remaining work a dispatch may run
+//
+// schedule() runs the loop over a VectorFeed directly, so feed calls bind
+// statically too; run() takes any feed through the virtual interface.
+
+// Admission order. The queue's front runs next and a process that yields goes
+// to the back, behind anything that arrived during its slice. A power-of-two
+// ring, so a yield is two index updates and never touches the allocator.
+class FifoQueue {
+public:
+    explicit FifoQueue(const ProcessFeed& feed) : ring(16, 0, feed.memory()) {}
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    // The i-th queued slot from the front.
+    int operator[](size_t i) const { return ring[(head + i) & (ring.size() - 1)]; }
+
+    void push(int slot) {
+        if (count == ring.size()) grow();
+        ring[(head + count++) & (ring.size() - 1)] = slot;
+    }
+    int next() const { return ring[head]; }
+    // Picking the front is one step whatever the length.
+    std::uint32_t work() const { return 1; }
+    void finish() {
+        head = (head + 1) & (ring.size() - 1);
+        count--;
+    }
+    void yield(int slot) {
+        finish();
+        push(slot);
+    }
+
+private:
+    void grow() {
+        std::pmr::vector<int> wider(2 * ring.size(), 0, ring.get_allocator());
+        for (size_t i = 0; i < count; ++i) wider[i] = (*this)[i];
+        ring.swap(wider);
+        head = 0;
+    }
+
+    std::pmr::vector<int> ring;
+    size_t head = 0;
+    size_t count = 0;
+};
+
+// Smallest `Key` first, in readyOrder. A process that yields keeps its place,
+// so its key may only have gone down while it ran.
+template <typename Key>
+class KeyedQueue {
+public:
+    explicit KeyedQueue(const ProcessFeed& feed) : heap(readyOrder(feed.storage(), Key()), feed.memory()) {}
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    void push(int slot) { heap.push(slot); }
+    int next() const { return heap.top(); }
+    // Popping or sifting the top walks the heap's depth.
+    std::uint32_t work() const { return treeWork(heap.size()); }
+    void finish() { heap.pop(); }
+    void yield(int slot) { heap.decreaseKey(slot); }
+
+private:
+    IndexedMinHeap<decltype(readyOrder(std::declval<const std::vector<Process>&>(), Key()))> heap;
+};
+
+// Smallest `Key` first, like KeyedQueue, but found by a masked linear scan
+// (maskedArgmin) over columns of the queued processes in admission order, so
+// equal keys go to the earlier admission. A finished process's row is marked
+// -1 rather than erased; the marked rows are squeezed out once they outnumber
+// the queued ones. The mark column doubles as the kernel's arrival column,
+// since every queued row has arrived by time 0 in its terms.
+template <typename Key>
+class ScanQueue {
+public:
+    explicit ScanQueue(const ProcessFeed& feed)
+        : feed(feed), slots(feed.memory()), keys(feed.memory()), marks(feed.memory()), argmin(maskedArgmin()) {}
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    void push(int slot) {
+        slots.push_back(slot);
+        keys.push_back(Key()(feed.storage()[slot]));
+        marks.push_back(0);
+        count++;
+    }
+    int next() const {
+        picked = argmin(marks.data(), marks.data(), keys.data(), first, slots.size(), 0);
+        return slots[picked];
+    }
+    // The scan examines every row from the first queued one on.
+    std::uint32_t work() const { return slots.size() - first; }
+    void finish() {
+        marks[picked] = -1;
+        count--;
+        while (first < marks.size() && marks[first] < 0) first++;
+        if (marks.size() - first - count >= 64 && marks.size() - first - count >= count) squeeze();
+    }
+    void yield(int slot) { keys[picked] = Key()(feed.storage()[slot]); }
+
+private:
+    void squeeze() {
+        size_t kept = 0;
+        for (size_t row = first; row < marks.size(); ++row) {
+            if (marks[row] < 0) continue;
+            slots[kept] = slots[row];
+            keys[kept] = keys[row];
+            kept++;
+        }
+        slots.resize(kept);
+        keys.resize(kept);
+        marks.assign(kept, 0);
+        first = 0;
+    }
+
+    const ProcessFeed& feed;
+    std::pmr::vector<int> slots;
+    std::pmr::vector<SimTime> keys;
+    std::pmr::vector<SimTime> marks;  // 0 while queued, -1 once finished
+    MaskedArgminFn argmin;
+    size_t first = 0;  // rows before it are all finished
+    size_t count = 0;
+    mutable size_t picked = 0;  // row of the last next()
+};
+
+struct BurstKey {
+    SimTime operator()(const Process& p) const { return p.burst_time; }
+};
+struct RemainingKey {
+    SimTime operator()(const Process& p) const { return p.remaining_time; }
+};
+struct PriorityKey {
+    SimTime operator()(const Process& p) const { return p.priority; }
+};
+
+// A dispatch runs its whole slice.
+struct NonPreemptive {
+    template <typename Feed>
+    static SimTime limit(Feed&, SimTime run_time, SimTime) { return run_time; }
+};
+
+// A dispatch stops at the next arrival so the queue can reorder around it.
+// Keys that don't change while waiting can only be beaten at arrivals, so
+// this is the only preemption point such policies need.
+struct PreemptOnArrival {
+    template <typename Feed>
+    static SimTime limit(Feed& feed, SimTime run_time, SimTime now) {
+        return feed.hasNext() ? std::min(run_time, feed.nextArrival() - now) : run_time;
+    }
+};
+
+// Time-slice policies are copied per run, given the run's memory, and may
+// skip ahead over many dispatches at once before the engine picks one.
+struct RunToCompletion {
+    RunToCompletion() = default;
+    RunToCompletion(const RunToCompletion&, std::pmr::memory_resource*) {}
+
+    SimTime limit(const Process& p) const { return p.remaining_time; }
+    template <typename Feed, typename Queue>
+    bool skipAhead(Feed&, Gantt&, const Queue&, SimTime&) { return false; }
+};
+
+// At most `quantum` per dispatch. Over a FIFO queue that is round robin, and
+// whole rounds are fast-forwarded in closed form.
+class FixedQuantum {
+public:
+    explicit FixedQuantum(SimTime quantum) : quantum(quantum) {}
+    FixedQuantum(const FixedQuantum& config, std::pmr::memory_resource* memory) : quantum(config.quantum), turn(memory) {}
+
+    SimTime limit(const Process& p) const { return std::min(quantum, p.remaining_time); }
+
+    // Once a round has gone by since the last look, tries to skip whole rounds in one step.
+    template <typename Feed>
+    bool skipAhead(Feed& feed, Gantt& gantt, const FifoQueue& queue, SimTime& current_time) {
+        if (slices_to_check == 0) {
+            slices_to_check = queue.size();
+            if (queue.size() >= 2 && fastForward(feed, gantt, queue, current_time)) return true;
+        }
+        slices_to_check--;
+        return false;
+    }
+    template <typename Feed, typename Queue>
+    bool skipAhead(Feed&, Gantt&, const Queue&, SimTime&) { return false; }
+
+private:
+    // While nothing arrives and nothing finishes, a round gives every queued
+    // process one full quantum and leaves the queue as it was, so r rounds can
+    // be run at once: r is the most that ends before the next arrival (one
+    // landing on a slice boundary would be queued mid-round), before the stop
+    // time, and before any process gets down to its last quantum. Costs
+    // O(queue) however many slices it covers.
+    template <typename Feed>
+    bool fastForward(Feed& feed, Gantt& gantt, const FifoQueue& queue, SimTime& current_time) {
+        const SimTime round = quantum * (SimTime)queue.size();
+        SimTime rounds = (feed.stopTime() - current_time) / round;
+        if (feed.hasNext()) rounds = std::min(rounds, (feed.nextArrival() - current_time - 1) / round);
+        for (size_t i = 0; i < queue.size(); ++i) {
+            if (rounds <= 0) return false;
+            rounds = std::min(rounds, (feed[queue[i]].remaining_time - 1) / quantum);
+        }
+        if (rounds <= 0) return false;
+
+        turn.clear();
+        SimTime start = current_time;
+        for (size_t i = 0; i < queue.size(); ++i) {
+            Process& p = feed[queue[i]];
+            markDispatched(p, start);
+            p.remaining_time -= rounds * quantum;
+            turn.push_back(p.pid);
+            start += quantum;
+        }
+        gantt.appendRounds(turn.data(), turn.size(), current_time, quantum, rounds);
+        current_time += rounds * round;
+        return true;
+    }
+
+    SimTime quantum;
+    size_t slices_to_check = 0;
+    std::pmr::vector<std::uint32_t> turn;
+};
+
+template <typename ReadyQueue, typename Preemption, typename TimeSlice>
+class PolicyScheduler : public Scheduler {
+public:
+    explicit PolicyScheduler(TimeSlice time_slice = TimeSlice()) : time_slice(std::move(time_slice)) {}
+
+    void schedule(std::vector<Process>& processes, Gantt& gantt, SimTime& total_time,
+                  std::pmr::memory_resource* memory = std::pmr::get_default_resource()) override {
+        VectorFeed feed(processes, memory);
+        runOn(feed, gantt, total_time);
+    }
+    void run(ProcessFeed& feed, Gantt& gantt, SimTime& total_time) override {
+        runOn(feed, gantt, total_time);
+    }
+
+private:
+    // FIFO run to completion only ever looks at the front of the queue, so it
+    // admits one arrival at a time, just before running it, while its record
+    // is still in cache. The order is the same as admitting them all.
+    static constexpr bool admit_on_demand =
+        std::is_same_v<ReadyQueue, FifoQueue> && std::is_same_v<TimeSlice, RunToCompletion>;
+
+    template <typename Feed>
+    void runOn(Feed& feed, Gantt& gantt, SimTime& total_time) {
+        ReadyQueue ready(feed);
+        TimeSlice slice(time_slice, feed.memory());
+        SimTime current_time = feed.startTime();
+        auto admit = [&] {
+            while (feed.hasNext() && feed.nextArrival() <= current_time) {
+                if (admit_on_demand && !ready.empty()) break;
+                ready.push(feed.admit());
+            }
+        };
+
+        while (!ready.empty() || feed.hasNext()) {
+            if (feed.suspended(current_time)) break;
+            admit();
+            if (ready.empty()) {
+                current_time = feed.nextArrival();
+                continue;
+            }
+            if (slice.skipAhead(feed, gantt, ready, current_time)) continue;
+
+            int slot = ready.next();
+            Process& p = feed[slot];
+            SimTime run_time = Preemption::limit(feed, slice.limit(p), current_time);
+            markDispatched(p, current_time);
+            gantt.append(p.pid, current_time, run_time, ready.work());
+            p.remaining_time -= run_time;
+            current_time += run_time;
+
+            if (p.remaining_time == 0) {
+                ready.finish();
+                p.turnaround_time = current_time - p.arrival_time;
+                p.waiting_time = p.turnaround_time - p.burst_time;
+                feed.retire(slot);
+            } else {
+                // In a FIFO, arrivals during the slice queue ahead of the process
+                // that yields; a keyed queue orders them by key either way.
+                if constexpr (std::is_same_v<ReadyQueue, FifoQueue>) admit();
+                ready.yield(slot);
+            }
+        }
+        total_time = current_time;
+    }
+
+    TimeSlice time_slice;
+};
+
+class FCFSScheduler : public PolicyScheduler<FifoQueue, NonPreemptive, RunToCompletion> {
+public:
+    bool smpPolicy(SMPPolicy& policy) const override {
+        policy = {SMPPolicy::Key::Arrival, false, 0};
+        return true;
+    }
+};
+
+// The heap policies below can also pick by a linear scan: over a column table
+// of the whole workload for schedule(), and over a ScanQueue on the shared
+// engine for run(), so streamed, resumed and stopped runs scan too.
+template <typename Key, typename Preemption, ScanKey scan_key, SMPPolicy::Key smp_key>
+class KeyedScheduler : public PolicyScheduler<KeyedQueue<Key>, Preemption, RunToCompletion> {
+    using Engine = PolicyScheduler<KeyedQueue<Key>, Preemption, RunToCompletion>;
+    using ScanEngine = PolicyScheduler<ScanQueue<Key>, Preemption, RunToCompletion>;
+    static constexpr bool preemptive = std::is_same_v<Preemption, PreemptOnArrival>;
+
+public:
+    explicit KeyedScheduler(ReadySelect select = ReadySelect::Heap) : select(select) {}
+    bool smpPolicy(SMPPolicy& policy) const override {
+        policy = {smp_key, preemptive, 0};
+        return true;
+    }
+    void schedule(std::vector<Process>& processes, Gantt& gantt, SimTime& total_time,
+                  std::pmr::memory_resource* memory = std::pmr::get_default_resource()) override {
+        if (select == ReadySelect::Scan) {
+            scheduleByScan(processes, gantt, total_time, scan_key, preemptive, memory);
+            return;
+        }
+        Engine::schedule(processes, gantt, total_time, memory);
+    }
+    void run(ProcessFeed& feed, Gantt& gantt, SimTime& total_time) override {
+        if (select == ReadySelect::Scan) {
+            by_scan.run(feed, gantt, total_time);
+            return;
+        }
+        Engine::run(feed, gantt, total_time);
+    }
+
+private:
+    ReadySelect select;
+    ScanEngine by_scan;
+};
+
+using SJFScheduler = KeyedScheduler<BurstKey, NonPreemptive, ScanKey::Burst, SMPPolicy::Key::Burst>;
+using SRTFScheduler = KeyedScheduler<RemainingKey, PreemptOnArrival, ScanKey::Remaining, SMPPolicy::Key::Remaining>;
+using PriorityScheduler = KeyedScheduler<PriorityKey, NonPreemptive, ScanKey::Priority, SMPPolicy::Key::Priority>;
+
+class RoundRobinScheduler : public PolicyScheduler<FifoQueue, NonPreemptive, FixedQuantum> {
+public:
+    explicit RoundRobinScheduler(int q) : PolicyScheduler(FixedQuantum(q)), quantum(q) {}
+    bool smpPolicy(SMPPolicy& policy) const override {
+        policy = {SMPPolicy::Key::Enqueue, false, quantum};
+        return true;
+    }
+
+private:
+    int quantum;
+};
+
+// Two fixed queues: priorities 1-2 share the CPU round robin, and priorities
+// 3 and up run first-come first-served, to completion, only while the first
+// queue is empty.
+class MLQScheduler : public Scheduler {
+private:
+    int quantum;
+public:
+    MLQScheduler(int q) : quantum(q) {}
+    void run(ProcessFeed& feed, Gantt& gantt, SimTime& total_time) override {
+        using Queue = std::queue<int, std::pmr::deque<int>>;
+        Queue high_queue{std::pmr::deque<int>(feed.memory())};
+        Queue low_queue{std::pmr::deque<int>(feed.memory())};
+        auto admit = [&](SimTime now) {
+            while (feed.hasNext() && feed.nextArrival() <= now) {
+                int slot = feed.admit();
+                (feed[slot].priority < 3 ? high_queue : low_queue).push(slot);
+            }
+        };
+        SimTime current_time = feed.startTime();
+
+        while (!high_queue.empty() || !low_queue.empty() || feed.hasNext()) {
+            if (feed.suspended(current_time)) break;
+            admit(current_time);
+
+            if (high_queue.empty() && low_queue.empty()) {
+                current_time = feed.nextArrival();
+                continue;
+            }
+
+            bool high = !high_queue.empty();
+            Queue& queue = high ? high_queue : low_queue;
+            int current = queue.front();
+            queue.pop();
+
+            SimTime run_time = feed[current].remaining_time;
+            if (high) run_time = std::min<SimTime>(quantum, run_time);
+
+            markDispatched(feed[current], current_time);
+            gantt.append(feed[current].pid, current_time, run_time, 1);
+            feed[current].remaining_time -= run_time;
+            current_time += run_time;
+            admit(current_time);
+
+            Process& p = feed[current];
+            if (p.remaining_time > 0) {
+                high_queue.push(current);
+            } else {
+                p.turnaround_time = current_time - p.arrival_time;
+                p.waiting_time = p.turnaround_time - p.burst_time;
+                feed.retire(current);
+            }
+        }
+        total_time = current_time;
+    }
+};
+
+// Up to 140 round-robin levels, as many as Linux has priorities.
+constexpr int MLFQ_MAX_LEVELS = 140;
+
+// One set of MLFQ level queues: FIFO lists threaded through a per-slot `next`
+// array, plus a bitmap of the non-empty levels so the highest one is found
+// with a find-first-set on at most three words.
+struct MLFQLevels {
+    static constexpr int words = (MLFQ_MAX_LEVELS + 63) / 64;
+
+    int head[MLFQ_MAX_LEVELS];
+    int tail[MLFQ_MAX_LEVELS];
+    std::uint64_t nonempty[words] = {};
+
+    MLFQLevels() {
+        std::fill(head, head + MLFQ_MAX_LEVELS, -1);
+        std::fill(tail, tail + MLFQ_MAX_LEVELS, -1);
+    }
+
+    bool empty() const {
+        for (int w = 0; w < words; ++w) {
+            if (nonempty[w]) return false;
+        }
+        return true;
+    }
+
+    // Highest (numerically lowest) non-empty level, or -1.
+    int top() const {
+        for (int w = 0; w < words; ++w) {
+            if (nonempty[w]) return w * 64 + __builtin_ctzll(nonempty[w]);
+        }
+        return -1;
+    }
+
+    void push(int level, int slot, std::pmr::vector<int>& next) {
+        next[slot] = -1;
+        if (tail[level] == -1) {
+            head[level] = slot;
+            nonempty[level / 64] |= 1ull << (level % 64);
+        } else {
+            next[tail[level]] = slot;
+        }
+        tail[level] = slot;
+    }
+
+    int pop(int level, const std::pmr::vector<int>& next) {
+        int slot = head[level];
+        head[level] = next[slot];
+        if (head[level] == -1) {
+            tail[level] = -1;
+            nonempty[level / 64] &= ~(1ull << (level % 64));
+        }
+        return slot;
+    }
+};
+
+// Multilevel feedback queue. Arrivals enter level 0. Each level has its own
+// quantum and allotment: a process is demoted once its CPU time at a level,
+// summed over all its slices there, reaches the allotment, so splitting work
+// into short bursts doesn't keep it on top. Every `boost_period` units all
+// processes go back to level 0 with fresh allotments.
+//
+// Boosts are lazy. Crossing a boost boundary moves the whole set of queues
+// into a list of boosted generations in O(1) and starts an empty set; the
+// processes in it are still filed under their old levels. They are dispatched
+// ahead of the current set (oldest generation first, in their old level
+// order) and are reset to level 0 only when next dispatched, by comparing the
+// epoch they were last placed in with the current one.
+class MLFQScheduler : public Scheduler {
+private:
+    std::vector<SimTime> quanta;
+    std::vector<SimTime> allotments;
+    SimTime boost_period;
+public:
+    MLFQScheduler(std::vector<SimTime> quanta, std::vector<SimTime> allotments, SimTime boost_period)
+        : quanta(std::move(quanta)), allotments(std::move(allotments)), boost_period(boost_period) {
+        if (this->quanta.empty()) this->quanta.push_back(1);
+        if (this->quanta.size() > MLFQ_MAX_LEVELS) this->quanta.resize(MLFQ_MAX_LEVELS);
+        this->allotments.resize(this->quanta.size(), 0);
+        for (size_t level = 0; level < this->quanta.size(); ++level) {
+            this->quanta[level] = std::max<SimTime>(1, this->quanta[level]);
+            if (this->allotments[level] <= 0) this->allotments[level] = this->quanta[level];
+        }
+    }
+
+    void run(ProcessFeed& feed, Gantt& gantt, SimTime& total_time) override {
+        const int levels = quanta.size();
+        std::pmr::vector<int> next(feed.memory()), level(feed.memory());
+        std::pmr::vector<SimTime> epoch(feed.memory());
+        std::pmr::vector<SimTime> used(feed.memory());
+        std::pmr::deque<MLFQLevels> boosted(feed.memory());
+        MLFQLevels current;
+        SimTime current_epoch = 0;
+        size_t live = 0;
+
+        auto admit = [&](SimTime now) {
+            while (feed.hasNext() && feed.nextArrival() <= now) {
+                int slot = feed.admit();
+                if (slot >= (int)next.size()) {
+                    next.resize(slot + 1);
+                    level.resize(slot + 1);
+                    epoch.resize(slot + 1);
+                    used.resize(slot + 1);
+                }
+                level[slot] = 0;
+                epoch[slot] = current_epoch;
+                used[slot] = 0;
+                current.push(0, slot, next);
+                live++;
+            }
+        };
+        SimTime current_time = feed.startTime();
+
+        while (live > 0 || feed.hasNext()) {
+            if (feed.suspended(current_time)) break;
+            admit(current_time);
+
+            if (live == 0) {
+                current_time = feed.nextArrival();
+                continue;
+            }
+
+            SimTime boundary = boost_period > 0 ? current_time / boost_period : 0;
+            if (boundary != current_epoch) {
+                if (!current.empty()) boosted.push_back(current);
+                current = MLFQLevels();
+                current_epoch = boundary;
+            }
+            while (!boosted.empty() && boosted.front().empty()) boosted.pop_front();
+
+            MLFQLevels& from = boosted.empty() ? current : boosted.front();
+            int slot = from.pop(from.top(), next);
+            if (epoch[slot] != current_epoch) {
+                level[slot] = 0;
+                used[slot] = 0;
+                epoch[slot] = current_epoch;
+            }
+
+            int l = level[slot];
+            SimTime run_time = std::min(quanta[l], feed[slot].remaining_time);
+            markDispatched(feed[slot], current_time);
+            gantt.append(feed[slot].pid, current_time, run_time, 1);
+            feed[slot].remaining_time -= run_time;
+            used[slot] += run_time;
+            current_time += run_time;
+            admit(current_time);
+
+            Process& p = feed[slot];
+            if (p.remaining_time > 0) {
+                if (used[slot] >= allotments[l] && l + 1 < levels) {
+                    level[slot] = l + 1;
+                    used[slot] = 0;
+                }
+                current.push(level[slot], slot, next);
+            } else {
+                live--;
+                p.turnaround_time = current_time - p.arrival_time;
+                p.waiting_time = p.turnaround_time - p.burst_time;
+                feed.retire(slot);
+            }
+        }
+        total_time = current_time;
+    }
+};
+
+// Fenwick tree over per-slot ticket counts: updating one holder and drawing
+// the holder of a given ticket both cost O(log n). It grows as slots appear.
+class TicketTree {
+public:
+    explicit TicketTree(std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : tree(1, 0, memory), count(memory) {}
+
+    long long total() const { return sum; }
+    size_t size() const { return count.size(); }
+    long long tickets(int i) const { return i < (int)count.size() ? count[i] : 0; }
+
+    // Drops every holder, keeping the storage.
+    void clear() {
+        std::fill(tree.begin(), tree.end(), 0);
+        std::fill(count.begin(), count.end(), 0);
+        sum = 0;
+    }
+
+    void set(int i, long long tickets) {
+        if (i >= (int)count.size()) grow(i + 1);
+        long long delta = tickets - count[i];
+        count[i] = tickets;
+        sum += delta;
+        for (size_t k = i + 1; k < tree.size(); k += k & -k) {
+            tree[k] += delta;
+        }
+    }
+
+    // Slot holding `ticket`, for 0 <= ticket < total().
+    int find(long long ticket) const {
+        size_t pos = 0;
+        size_t step = 1;
+        while (step * 2 < tree.size()) step *= 2;
+        for (; step > 0; step /= 2) {
+            if (pos + step < tree.size() && tree[pos + step] <= ticket) {
+                pos += step;
+                ticket -= tree[pos];
+            }
+        }
+        return pos;
+    }
+
+private:
+    // Rebuilds the tree at double the needed size in O(n).
+    void grow(size_t needed) {
+        count.resize(std::max(needed, 2 * count.size()), 0);
+        tree.assign(count.size() + 1, 0);
+        for (size_t k = 1; k < tree.size(); ++k) {
+            tree[k] += count[k - 1];
+            size_t parent = k + (k & -k);
+            if (parent < tree.size()) tree[parent] += tree[k];
+        }
+    }
+
+    std::pmr::vector<long long> tree;
+    std::pmr::vector<long long> count;
+    long long sum = 0;
+};
+
+// Draws the next process to run with probability proportional to its tickets,
+// max(1, 10 / priority), from a generator seeded with `seed` so runs repeat.
+// With quantum 0 each winner runs to completion. Otherwise a new draw happens
+// every quantum and at each arrival, and a winner cut short by an arrival gets
+// compensation tickets (quantum / used times its own) until it wins again.
+//
+// Holders sit in the ticket tree in admission order, not by slot, so a draw
+// picks the same process whichever feed the run uses and however it reuses
+// slots; a streamed trace draws exactly as the loaded one. Positions of
+// finished processes are squeezed out once they make up most of the tree,
+// which keeps the relative order and so every later draw.
+class LotteryScheduler : public Scheduler {
+private:
+    int quantum;
+    std::uint64_t seed;
+public:
+    LotteryScheduler(int q, std::uint64_t seed) : quantum(q), seed(seed) {}
+    void run(ProcessFeed& feed, Gantt& gantt, SimTime& total_time) override {
+        std::mt19937_64 gen(seed);
+        TicketTree tickets(feed.memory());
+        std::pmr::vector<int> holder(feed.memory());    // position -> slot, -1 once finished
+        std::pmr::vector<int> position(feed.memory());  // slot -> position
+        auto baseTickets = [](const Process& p) { return std::max(1, 10 / std::max(1, p.priority)); };
+        SimTime current_time = feed.startTime();
+        size_t live = 0;
+
+        auto compact = [&] {
+            std::pmr::vector<long long> kept(feed.memory());
+            size_t n = 0;
+            for (size_t pos = 0; pos < holder.size(); ++pos) {
+                if (holder[pos] == -1) continue;
+                kept.push_back(tickets.tickets(pos));
+                holder[n] = holder[pos];
+                position[holder[n]] = n;
+                n++;
+            }
+            holder.resize(n);
+            tickets.clear();
+            for (size_t pos = 0; pos < n; ++pos) tickets.set(pos, kept[pos]);
+        };
+
+        while (live > 0 || feed.hasNext()) {
+            if (feed.suspended(current_time)) break;
+            while (feed.hasNext() && feed.nextArrival() <= current_time) {
+                if (holder.size() >= 64 && holder.size() >= 2 * live) compact();
+                int slot = feed.admit();
+                if (slot >= (int)position.size()) position.resize(slot + 1);
+                position[slot] = holder.size();
+                holder.push_back(slot);
+                tickets.set(position[slot], baseTickets(feed[slot]));
+                live++;
+            }
+
+            if (live == 0) {
+                current_time = feed.nextArrival();
+                continue;
+            }
+
+            std::uniform_int_distribution<long long> draw(0, tickets.total() - 1);
+            int at = tickets.find(draw(gen));
+            int w = holder[at];
+            Process& winner = feed[w];
+            tickets.set(at, baseTickets(winner));
+
+            SimTime run_time = winner.remaining_time;
+            if (quantum > 0) {
+                run_time = std::min<SimTime>(run_time, quantum);
+                if (feed.hasNext()) run_time = std::min(run_time, feed.nextArrival() - current_time);
+            }
+
+            markDispatched(winner, current_time);
+            gantt.append(winner.pid, current_time, run_time, treeWork(live));
+            winner.remaining_time -= run_time;
+            current_time += run_time;
+
+            if (winner.remaining_time == 0) {
+                tickets.set(at, 0);
+                holder[at] = -1;
+                live--;
+                winner.turnaround_time = current_time - winner.arrival_time;
+                winner.waiting_time = winner.turnaround_time - winner.burst_time;
+                feed.retire(w);
+            } else if (run_time < quantum) {
+                tickets.set(at, baseTickets(winner) * quantum / run_time);
+            }
+        }
+        total_time = current_time;
+    }
+};
+
+// Linux's nice-to-weight table (kernel/sched/core.c): each nice step changes the
+// CPU share by about 10%, and nice 0 has weight NICE_0_LOAD.
+constexpr int NICE_0_LOAD = 1024;
+constexpr int sched_prio_to_weight[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+     9548,  7620,  6100,  4904,  3906,
+     3121,  2501,  1991,  1586,  1277,
+     1024,   820,   655,   526,   423,
+      335,   272,   215,   172,   137,
+      110,    87,    70,    56,    45,
+       36,    29,    23,    18,    15,
+};
+// 2^32 / weight, so vruntime updates multiply and shift instead of dividing.
+constexpr std::uint32_t sched_prio_to_wmult[40] = {
+     48388,     59856,     76040,     92818,    118348,
+    147320,    184698,    229616,    287308,    360437,
+    449829,    563644,    704093,    875809,   1099582,
+   1376151,   1717300,   2157191,   2708050,   3363326,
+   4194304,   5237765,   6557202,   8165337,  10153587,
+  12820798,  15790321,  19976592,  24970740,  31350126,
+  39045157,  49367440,  61356676,  76695844,  95443717,
+ 119304647, 148102320, 186737708, 238609294, 286331153,
+};
+
+// vruntime is fixed point: one unit of runtime at nice 0 adds 1 << CFS_VRUNTIME_SHIFT,
+// which keeps heavy (negative nice) tasks from rounding their progress to zero.
+constexpr int CFS_VRUNTIME_SHIFT = 10;
+
+// The simulator's priorities run 1 (highest) to 5; priority 3 maps to nice 0 and
+// each step to two nice levels, close to the old 10 / priority weight ratios.
+int cfsNice(const Process& p) {
+    return std::clamp(2 * (p.priority - 3), -20, 19);
+}
+
+// delta * NICE_0_LOAD / weight, in vruntime fixed point.
+SimTime cfsDeltaFair(SimTime delta, int nice) {
+    unsigned __int128 scaled = (unsigned __int128)delta * NICE_0_LOAD * sched_prio_to_wmult[nice + 20];
+    return (SimTime)(scaled >> (32 - CFS_VRUNTIME_SHIFT));
+}
+
+// Runnable tasks ordered by (vruntime, admission order). std::set is a red-black tree whose
+// begin() is the cached leftmost node, so picking the next task is O(1) and
+// enqueue/dequeue are O(log n). The running task is kept out of the tree but
+// stays in the load, as in the kernel.
+class CFSRunQueue {
+public:
+    explicit CFSRunQueue(std::pmr::memory_resource* memory = std::pmr::get_default_resource()) : tree(memory) {}
+
+    bool empty() const { return tree.empty(); }
+    int leftmost() const { return std::get<2>(*tree.begin()); }
+    SimTime leftmostVruntime() const { return std::get<0>(*tree.begin()); }
+    long long load() const { return load_weight; }
+    size_t nrRunning() const { return nr_running; }
+    SimTime minVruntime() const { return min_vruntime; }
+
+    void enqueue(const Process& p, int slot) { tree.insert({p.vruntime, p.seq, slot}); }
+    void dequeue(const Process& p, int slot) { tree.erase({p.vruntime, p.seq, slot}); }
+    void addLoad(const Process& p) { load_weight += sched_prio_to_weight[cfsNice(p) + 20]; nr_running++; }
+    void removeLoad(const Process& p) { load_weight -= sched_prio_to_weight[cfsNice(p) + 20]; nr_running--; }
+
+    // min_vruntime only moves forward; it follows the smaller of the running
+    // task and the leftmost queued task.
+    void updateMinVruntime(const Process* curr) {
+        SimTime v = min_vruntime;
+        bool found = false;
+        if (curr) { v = curr->vruntime; found = true; }
+        if (!tree.empty()) { v = found ? std::min(v, leftmostVruntime()) : leftmostVruntime(); found = true; }
+        if (found) min_vruntime = std::max(min_vruntime, v);
+    }
+
+private:
+    std::pmr::set<std::tuple<SimTime, std::uint64_t, int>> tree;
+    long long load_weight = 0;
+    size_t nr_running = 0;
+    SimTime min_vruntime = 0;
+};
+
+class CFSScheduler : public Scheduler {
+private:
+    SimTime sched_latency;
+    SimTime min_granularity;
+public:
+    CFSScheduler(SimTime latency, SimTime granularity) : sched_latency(latency), min_granularity(std::max<SimTime>(1, granularity)) {}
+
+    void run(ProcessFeed& feed, Gantt& gantt, SimTime& total_time) override {
+        CFSRunQueue rq(feed.memory());
+        SimTime current_time = feed.startTime();
+        int curr = -1;
+        SimTime slice_end = 0;
+
+        while(curr != -1 || !rq.empty() || feed.hasNext()){
+            if(feed.suspended(current_time)) break;
+            // New tasks start at min_vruntime so they neither starve the queue nor
+            // get credit for time before they arrived. One that lands far enough
+            // behind the running task preempts it, as a kernel wakeup would.
+            while(feed.hasNext() && feed.nextArrival() <= current_time){
+                int slot = feed.admit();
+                Process& p = feed[slot];
+                p.vruntime = rq.minVruntime();
+                rq.enqueue(p, slot);
+                rq.addLoad(p);
+            }
+            if(curr != -1 && !rq.empty() &&
+               feed[curr].vruntime - rq.leftmostVruntime() > cfsDeltaFair(min_granularity, cfsNice(feed[rq.leftmost()]))){
+                rq.enqueue(feed[curr], curr);
+                curr = -1;
+            }
+
+            // A task kept past an arrival continues its slice; only a pick is a decision.
+            std::uint32_t work = 0;
+            if(curr == -1){
+                if(rq.empty()){
+                    current_time = feed.nextArrival();
+                    continue;
+                }
+                work = treeWork(rq.nrRunning());
+                curr = rq.leftmost();
+                rq.dequeue(feed[curr], curr);
+                slice_end = current_time + timeslice(feed[curr], rq);
+            }
+
+            Process& p = feed[curr];
+            SimTime run_until = std::min(slice_end, current_time + p.remaining_time);
+            if(feed.hasNext()){
+                run_until = std::min(run_until, feed.nextArrival());
+            }
+            SimTime run_time = run_until - current_time;
+
+            markDispatched(p, current_time);
+            gantt.append(p.pid, current_time, run_time, work);
+
+            p.remaining_time -= run_time;
+            p.vruntime += cfsDeltaFair(run_time, cfsNice(p));
+            current_time = run_until;
+            rq.updateMinVruntime(&p);
+
+            if(p.remaining_time == 0){
+                rq.removeLoad(p);
+                p.turnaround_time = current_time - p.arrival_time;
+                p.waiting_time = p.turnaround_time - p.burst_time;
+                feed.retire(curr);
+                curr = -1;
+            } else if(current_time == slice_end){
+                rq.enqueue(p, curr);
+                curr = -1;
+            }
+        }
+        total_time = current_time;
+    }
+
+private:
+    // The task's weighted share of the scheduling period, where the period
+    // stretches past sched_latency once every task can't get min_granularity.
+    SimTime timeslice(const Process& p, const CFSRunQueue& rq) const {
+        SimTime nr = rq.nrRunning();
+        SimTime period = (nr * min_granularity > sched_latency) ? nr * min_granularity : sched_latency;
+        SimTime slice = period * sched_prio_to_weight[cfsNice(p) + 20] / rq.load();
+        return std::max(slice, min_granularity);
+    }
+};
+
+// A process's absolute deadline; one without a deadline gets arrival + 2 * burst.
+SimTime edfDeadline(const Process& p) {
+    return p.deadline != 0 ? p.deadline : p.arrival_time + p.burst_time * 2;
+}
+
+// Preemptive earliest deadline first. Deadlines only change at arrivals, so
+// the running process keeps the CPU until the next arrival or its completion,
+// and it stays at the top of the heap while it runs.
+struct DeadlineKey {
+    SimTime operator()(const Process& p) const { return edfDeadline(p); }
+};
+
+class EDFScheduler : public PolicyScheduler<KeyedQueue<DeadlineKey>, PreemptOnArrival, RunToCompletion> {
+public:
+    bool smpPolicy(SMPPolicy& policy) const override {
+        policy = {SMPPolicy::Key::Deadline, true, 0};
+        return true;
+    }
+};
+
+// A periodic real-time task: a job of `wcet` units is released at
+// offset + k * period and is due `deadline` units after its release.
+struct PeriodicTask {
+    std::uint32_t pid;
+    SimTime period;
+    SimTime wcet;
+    SimTime deadline;
+    SimTime offset;
+};
+
+// Reads "id period wcet deadline offset" lines.
+std::vector<PeriodicTask> loadPeriodicTasks(const std::string& filename, ProcessNames& names) {
+    std::vector<PeriodicTask> tasks;
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Error opening file: " << filename << "\n";
+        return tasks;
+    }
+    std::string id;
+    SimTime period, wcet, deadline, offset;
+    while (file >> id >> period >> wcet >> deadline >> offset) {
+        if (period <= 0 || wcet <= 0 || deadline <= 0 || offset < 0) {
+            std::cerr << "Skipping invalid task " << id << "\n";
+            continue;
+        }
+        tasks.push_back({names.intern(id), period, wcet, deadline, offset});
+    }
+    return tasks;
+}
+
+// Length of the interval whose schedule repeats: the hyperperiod for
+// synchronous task sets, max offset + 2 * hyperperiod otherwise. 0 if the
+// hyperperiod doesn't fit in SimTime.
+SimTime periodicHorizon(const std::vector<PeriodicTask>& tasks) {
+    SimTime hyperperiod = 1;
+    SimTime max_offset = 0;
+    for (const auto& t : tasks) {
+        SimTime step = t.period / std::gcd(hyperperiod, t.period);
+        if (hyperperiod > std::numeric_limits<SimTime>::max() / 4 / step) return 0;
+        hyperperiod *= step;
+        max_offset = std::max(max_offset, t.offset);
+    }
+    return max_offset == 0 ? hyperperiod : max_offset + 2 * hyperperiod;
+}
+
+// Releases jobs of a periodic task set lazily, in release order, up to
+// `horizon`. Only the next release of each task is kept, in a timer wheel, and
+// finished jobs' slots are reused, so nothing is materialized per job. Every
+// job of a task shares the task's pid, so Gantt names are task names.
+class PeriodicFeed : public ProcessFeed {
+public:
+    PeriodicFeed(const std::vector<PeriodicTask>& tasks, SimTime horizon, RunMetrics& metrics)
+        : tasks(tasks), horizon(horizon), metrics(metrics) {
+        slots = &pool;
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            if (tasks[i].offset < horizon) releases.insert(tasks[i].offset, i, i);
+        }
+    }
+
+    bool hasNext() const override { return !releases.empty(); }
+    SimTime nextArrival() const override { return releases.nextTime(); }
+
+    int admit() override {
+        SimTime release = releases.nextTime();
+        size_t i = releases.pop();
+        if (release + tasks[i].period < horizon) releases.insert(release + tasks[i].period, i, i);
+
+        Process job{tasks[i].pid, release, tasks[i].wcet, 0};
+        job.deadline = release + tasks[i].deadline;
+        int slot;
+        if (free_slots.empty()) {
+            slot = pool.size();
+            pool.push_back(job);
+        } else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+            pool[slot] = job;
+        }
+        prepare(pool[slot], admitted++);
+        return slot;
+    }
+
+    void retire(int slot) override {
+        metrics.add(pool[slot]);
+        free_slots.push_back(slot);
+    }
+
+private:
+    const std::vector<PeriodicTask>& tasks;
+    SimTime horizon;
+    RunMetrics& metrics;
+    std::vector<Process> pool;
+    std::vector<int> free_slots;
+    mutable TimerWheel releases;  // next release of each task, tied by task index
+    std::uint64_t admitted = 0;
+};
+
+struct Schedulability {
+    double utilization = 0;
+    bool feasible = false;
+    std::string test;  // which test decided it
+};
+
+// Exact EDF feasibility for one processor. Utilization above 1 is infeasible
+// and, when every deadline is at least its period, utilization up to 1 is
+// feasible. Otherwise the processor-demand criterion is checked with Quick
+// Processor-demand Analysis (Zhang & Burns), which walks deadlines downward
+// from the end of the testing interval instead of checking each one.
+// Offsets are ignored, which makes the answer sufficient for offset sets.
+Schedulability analyzeEDF(const std::vector<PeriodicTask>& tasks) {
+    Schedulability result;
+    for (const auto& t : tasks) result.utilization += (double)t.wcet / t.period;
+    if (result.utilization > 1 + 1e-12) {
+        result.test = "utilization bound";
+        return result;
+    }
+    bool implicit = std::all_of(tasks.begin(), tasks.end(), [](const PeriodicTask& t) { return t.deadline >= t.period; });
+    if (implicit) {
+        result.feasible = true;
+        result.test = "utilization bound";
+        return result;
+    }
+    result.test = "QPA";
+
+    // Demand of jobs released at 0 onward with deadlines at or before t.
+    auto demand = [&](SimTime t) {
+        SimTime h = 0;
+        for (const auto& task : tasks) {
+            if (t >= task.deadline) h += ((t - task.deadline) / task.period + 1) * task.wcet;
+        }
+        return h;
+    };
+    // Latest absolute deadline strictly before t, or 0.
+    auto deadlineBefore = [&](SimTime t) {
+        SimTime d = 0;
+        for (const auto& task : tasks) {
+            if (t <= task.deadline) continue;
+            SimTime k = (t - task.deadline - 1) / task.period;
+            d = std::max(d, k * task.period + task.deadline);
+        }
+        return d;
+    };
+
+    // Testing interval: the synchronous busy period, tightened by the
+    // Baruah bound when utilization is below 1.
+    SimTime busy = 0;
+    for (const auto& t : tasks) busy += t.wcet;
+    while (true) {
+        SimTime next = 0;
+        for (const auto& t : tasks) next += (busy + t.period - 1) / t.period * t.wcet;
+        if (next == busy) break;
+        busy = next;
+    }
+    SimTime limit = busy;
+    if (result.utilization < 1 - 1e-12) {
+        double bound = 0;
+        SimTime max_deadline = 0;
+        for (const auto& t : tasks) {
+            bound += (double)(t.period - t.deadline) * t.wcet / t.period;
+            max_deadline = std::max(max_deadline, t.deadline);
+        }
+        limit = std::min(limit, std::max(max_deadline, (SimTime)std::ceil(bound / (1 - result.utilization))));
+    }
+
+    SimTime d_min = std::numeric_limits<SimTime>::max();
+    for (const auto& t : tasks) d_min = std::min(d_min, t.deadline);
+    SimTime t = deadlineBefore(limit + 1);
+    SimTime h = demand(t);
+    while (h <= t && h > d_min) {
+        t = (h < t) ? h : deadlineBefore(t);
+        h = demand(t);
+    }
+    result.feasible = h <= d_min;
+    return result;
+}
+
+void printSchedulability(ResultWriter& out, const Schedulability& result) {
+    out.put("Utilization: "); out.put(result.utilization); out.put('\n');
+    out.put("EDF Schedulable: "); out.put(result.feasible ? "yes" : "no");
+    out.put(" ("); out.put(result.test); out.put(")\n");
+}
+
+// Orders one CPU's run queue by the key each task was enqueued with, then
+// arrival time, then admission order, like readyOrder().
+struct SMPQueueOrder {
+    const std::vector<Process>* processes;
+    const std::vector<SimTime>* keys;
+
+    bool operator()(int a, int b) const {
+        if ((*keys)[a] != (*keys)[b]) return (*keys)[a] < (*keys)[b];
+        const Process& pa = (*processes)[a];
+        const Process& pb = (*processes)[b];
+        if (pa.arrival_time != pb.arrival_time) return pa.arrival_time < pb.arrival_time;
+        return pa.seq < pb.seq;
+    }
+};
+
+struct SMPCpu {
+    explicit SMPCpu(SMPQueueOrder order) : queue(order) {}
+
+    size_t load() const { return queue.size() + (current != -1); }
+
+    IndexedMinHeap<SMPQueueOrder> queue;
+    int current = -1;
+    SimTime slice_end = 0;
+    SimTime busy = 0;             // time spent running tasks, migration warmup included
+    size_t completed = 0;
+    size_t migrations_in = 0;
+    std::uint32_t pick_work = 0;  // work of the pick behind the next slice; 0 once it runs on
+    Gantt lane;
+    OverheadMeter meter;
+};
+
+// Everything an SMP run reports beyond the per-process results.
+struct SMPRun {
+    std::vector<SMPCpu> cpus;
+    SimTime total_time = 0;
+    size_t migrations = 0;
+    SimTime migration_time = 0;
+    bool metered = false;  // each CPU's meter was charged DispatchCosts
+};
+
+// Runs a policy on `cpu_count` CPUs, each with its own run queue ordered by
+// `policy`. Arrivals go to the least loaded CPU. A CPU that runs dry steals
+// the best queued task from the most loaded one, and every `balance_interval`
+// tasks are pushed from the most to the least loaded CPU until their loads
+// differ by at most one. Each migration adds `migration_cost` to the task's
+// remaining work, standing in for the cache refill on its new CPU. Time jumps
+// from event to event as in the single-CPU schedulers. Each CPU's dispatches
+// are also charged `costs` on its own meter, on top of the migration cost.
+class SMPSimulator {
+public:
+    SMPSimulator(const SMPPolicy& policy, size_t cpu_count, SimTime balance_interval, SimTime migration_cost,
+                 const DispatchCosts& costs = DispatchCosts())
+        : policy(policy), cpu_count(std::max<size_t>(1, cpu_count)),
+          balance_interval(balance_interval), migration_cost(migration_cost), costs(costs) {}
+
+    void run(std::vector<Process>& processes, SMPRun& result) {
+        VectorFeed feed(processes);
+        keys.assign(processes.size(), 0);
+        overhead.assign(processes.size(), 0);
+        result = SMPRun{};
+        for (size_t c = 0; c < cpu_count; ++c) {
+            result.cpus.emplace_back(SMPQueueOrder{&processes, &keys});
+        }
+        result.metered = costs.enabled();
+        if (result.metered) {
+            for (auto& cpu : result.cpus) {
+                cpu.meter = OverheadMeter(costs);
+                cpu.lane.meterTo(&cpu.meter);
+            }
+        }
+        std::vector<SMPCpu>& cpus = result.cpus;
+        std::vector<int> expired;
+
+        SimTime current_time = 0;
+        SimTime next_balance = balance_interval;
+        size_t completed = 0;
+        while(completed < processes.size()){
+            admit(feed, cpus, current_time);
+
+            if(policy.preemptive){
+                for(auto& cpu : cpus){
+                    if(cpu.current != -1 && !cpu.queue.empty() &&
+                       keys[cpu.queue.top()] < keyOf(feed[cpu.current])){
+                        enqueue(cpu, cpu.current, feed[cpu.current]);
+                        cpu.current = -1;
+                    }
+                }
+            }
+            if(balance_interval > 0 && current_time >= next_balance){
+                balance(feed, result);
+                next_balance = (current_time / balance_interval + 1) * balance_interval;
+            }
+            for(auto& cpu : cpus){
+                if(cpu.current == -1 && cpu.queue.empty()) steal(feed, cpu, result);
+                if(cpu.current == -1 && !cpu.queue.empty()){
+                    cpu.pick_work = treeWork(cpu.queue.size());
+                    cpu.current = cpu.queue.pop();
+                    cpu.slice_end = policy.quantum > 0 ? current_time + policy.quantum : std::numeric_limits<SimTime>::max();
+                }
+            }
+
+            SimTime next_event = feed.hasNext() ? feed.nextArrival() : std::numeric_limits<SimTime>::max();
+            bool running = false;
+            bool waiting = false;
+            for(const auto& cpu : cpus){
+                if(cpu.current != -1){
+                    running = true;
+                    next_event = std::min({next_event, cpu.slice_end, current_time + feed[cpu.current].remaining_time});
+                }
+                waiting = waiting || !cpu.queue.empty();
+            }
+            if(!running){
+                current_time = feed.nextArrival();
+                continue;
+            }
+            if(waiting && balance_interval > 0) next_event = std::min(next_event, next_balance);
+
+            SimTime run_time = next_event - current_time;
+            expired.clear();
+            for(size_t c = 0; c < cpus.size(); ++c){
+                SMPCpu& cpu = cpus[c];
+                if(cpu.current == -1) continue;
+                Process& p = feed[cpu.current];
+                markDispatched(p, current_time);
+                cpu.lane.append(p.pid, current_time, run_time, cpu.pick_work);
+                cpu.pick_work = 0;
+                cpu.busy += run_time;
+                p.remaining_time -= run_time;
+                if(p.remaining_time == 0){
+                    p.turnaround_time = next_event - p.arrival_time;
+                    p.waiting_time = p.turnaround_time - p.burst_time - overhead[cpu.current];
+                    cpu.completed++;
+                    completed++;
+                    cpu.current = -1;
+                } else if(next_event == cpu.slice_end){
+                    expired.push_back(c);
+                }
+            }
+            current_time = next_event;
+
+            // Arrivals that landed during the slice queue ahead of the task whose quantum expired.
+            admit(feed, cpus, current_time);
+            for(size_t c : expired){
+                enqueue(cpus[c], cpus[c].current, feed[cpus[c].current]);
+                cpus[c].current = -1;
+            }
+        }
+        result.total_time = current_time;
+    }
+
+private:
+    // The task's run-queue key as of now.
+    SimTime keyOf(const Process& p) {
+        switch (policy.key) {
+            case SMPPolicy::Key::Arrival:   return p.seq;
+            case SMPPolicy::Key::Burst:     return p.burst_time;
+            case SMPPolicy::Key::Remaining: return p.remaining_time;
+            case SMPPolicy::Key::Priority:  return p.priority;
+            case SMPPolicy::Key::Deadline:  return edfDeadline(p);
+            case SMPPolicy::Key::Enqueue:   return enqueued++;
+        }
+        return 0;
+    }
+
+    void enqueue(SMPCpu& cpu, int slot, const Process& p) {
+        keys[slot] = keyOf(p);
+        cpu.queue.push(slot);
+    }
+
+    void admit(ProcessFeed& feed, std::vector<SMPCpu>& cpus, SimTime now) {
+        while(feed.hasNext() && feed.nextArrival() <= now){
+            int slot = feed.admit();
+            auto target = std::min_element(cpus.begin(), cpus.end(), [](const SMPCpu& a, const SMPCpu& b) {
+                return a.load() < b.load();
+            });
+            enqueue(*target, slot, feed[slot]);
+        }
+    }
+
+    void migrate(ProcessFeed& feed, SMPCpu& from, SMPCpu& to, SMPRun& result) {
+        int slot = from.queue.pop();
+        feed[slot].remaining_time += migration_cost;
+        overhead[slot] += migration_cost;
+        enqueue(to, slot, feed[slot]);
+        to.migrations_in++;
+        result.migrations++;
+        result.migration_time += migration_cost;
+    }
+
+    void steal(ProcessFeed& feed, SMPCpu& idle, SMPRun& result) {
+        auto victim = std::max_element(result.cpus.begin(), result.cpus.end(), [](const SMPCpu& a, const SMPCpu& b) {
+            return a.queue.size() < b.queue.size();
+        });
+        if(!victim->queue.empty()) migrate(feed, *victim, idle, result);
+    }
+
+    void balance(ProcessFeed& feed, SMPRun& result) {
+        auto byLoad = [](const SMPCpu& a, const SMPCpu& b) { return a.load() < b.load(); };
+        while(true){
+            auto busiest = std::max_element(result.cpus.begin(), result.cpus.end(), byLoad);
+            auto idlest = std::min_element(result.cpus.begin(), result.cpus.end(), byLoad);
+            if(busiest->load() <= idlest->load() + 1 || busiest->queue.empty()) break;
+            migrate(feed, *busiest, *idlest, result);
+        }
+    }
+
+    SMPPolicy policy;
+    size_t cpu_count;
+    SimTime balance_interval;
+    SimTime migration_cost;
+    DispatchCosts costs;
+    std::vector<SimTime> keys;      // run-queue key of each queued task, fixed at enqueue
+    std::vector<SimTime> overhead;  // migration warmup charged to each task
+    SimTime enqueued = 0;
+};
+
+void printSMPResults(ResultWriter& out, const std::vector<Process>& processes, const SMPRun& run, const ProcessNames& names,
+                     bool percentiles) {
+    RunMetrics metrics = collectMetrics(processes);
+    double avg_wait, avg_turn, cpu_util, throughput;
+    calculateMetrics(metrics, run.total_time, avg_wait, avg_turn, cpu_util, throughput);
+    SimTime busy = 0;
+    for (const auto& cpu : run.cpus) busy += cpu.busy;
+    double total = (double)run.total_time * run.cpus.size();
+
+    SegmentEncoder encoder(OutputFormat::Text, names);
+    out.put("Average Waiting Time: "); out.put(avg_wait); out.put('\n');
+    out.put("Average Turnaround Time: "); out.put(avg_turn); out.put('\n');
+    out.put("CPU Utilization: "); out.put(total > 0 ? busy / total * 100 : 0.0); out.put("%\n");
+    out.put("Throughput: "); out.put(throughput); out.put(" processes/unit time\n");
+    out.put("Migrations: "); out.put(run.migrations);
+    out.put(" ("); out.put(run.migration_time); out.put(" units of warmup)\n");
+    if (run.metered) {
+        std::uint64_t switches = 0;
+        double overhead = 0, effective = 0;
+        for (const auto& cpu : run.cpus) {
+            switches += cpu.meter.switchCount();
+            overhead += cpu.meter.overhead();
+            effective += run.total_time + cpu.meter.delay();
+        }
+        out.put("Context Switches: "); out.put(switches);
+        out.put(" ("); out.put(overhead); out.put(" units of overhead)\n");
+        out.put("Effective CPU Utilization: "); out.put(effective > 0 ? busy / effective * 100 : 0.0); out.put("%\n");
+    }
+    if (percentiles) printLatency(out, metrics, OutputFormat::Text);
+    for (size_t c = 0; c < run.cpus.size(); ++c) {
+        const SMPCpu& cpu = run.cpus[c];
+        double util = run.total_time > 0 ? (double)cpu.busy / run.total_time * 100 : 0;
+        double cpu_throughput = run.total_time > 0 ? (double)cpu.completed / run.total_time : 0;
+        out.put("CPU "); out.put(c); out.put(": Utilization: "); out.put(util);
+        out.put("%, Throughput: "); out.put(cpu_throughput);
+        out.put(" processes/unit time, Migrations in: "); out.put(cpu.migrations_in);
+        if (run.metered) {
+            out.put(", Switches: "); out.put(cpu.meter.switchCount());
+        }
+        out.put('\n');
+        out.put("CPU "); out.put(c); out.put(' ');
+        printGantt(out, cpu.lane, encoder);
+    }
+}
+
+// Builds the workload straight from the mapped columns; names go into `names`
+// under the trace's own indices, so `names` must start out empty.
+std::vector<Process> loadBinaryTrace(const std::string& filename, ProcessNames& names) {
+    std::vector<Process> processes;
+    try {
+        MappedTrace trace(filename);
+        for (size_t n = 0; n < trace.nameCount(); ++n) {
+            names.assign(n, trace.nameOf(n));
+        }
+        processes.reserve(trace.size());
+        for (size_t row = 0; row < trace.size(); ++row) {
+            processes.push_back(trace.process(row));
+        }
+        if (!trace.arrivalSorted()) {
+            std::stable_sort(processes.begin(), processes.end(), [](const Process& a, const Process& b) {
+                return a.arrival_time < b.arrival_time;
+            });
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error reading trace: " << e.what() << "\n";
+    }
+    return processes;
+}
+
+std::vector<Process> loadProcesses(const std::string& filename, ProcessNames& names) {
+    if (isBinaryTrace(filename)) {
+        return loadBinaryTrace(filename, names);
+    }
+    std::vector<Process> processes;
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Error opening file: " << filename << "\n";
+        return processes;
+    }
+    std::string id;
+    SimTime at, bt;
+    int pri;
+    while (file >> id >> at >> bt >> pri) {
+        processes.push_back({names.intern(id), at, bt, pri});
+    }
+    std::stable_sort(processes.begin(), processes.end(), [](const Process& a, const Process& b) {
+        return a.arrival_time < b.arrival_time;
+    });
+    return processes;
+}
+
+// Splits a comma-separated command-line list.
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+// 3"): a keyed bijection on 128-bit counters. Any draw is a pure function of
+// the seed and its counter, so workers can generate any part of a workload in
+// any order and get the same numbers.
+std::array<std::uint32_t, 4> philox(std::array<std::uint32_t, 4> ctr, std::uint64_t seed) {
+    std::uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    std::uint32_t k0 = seed, k1 = seed >> 32;
+    for (int round = 0; round < 10; ++round) {
+        std::uint64_t p0 = 0xD2511F53ull * c0;
+        std::uint64_t p1 = 0xCD9E8D57ull * c2;
+        c0 = std::uint32_t(p1 >> 32) ^ c1 ^ k0;
+        c2 = std::uint32_t(p0 >> 32) ^ c3 ^ k1;
+        c1 = std::uint32_t(p1);
+        c3 = std::uint32_t(p0);
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    return {c0, c1, c2, c3};
+}
+
+// Sequential draws from one Philox stream, identified by a 64-bit index and a
+// purpose, so unrelated quantities never share numbers.
+class CounterRng {
+public:
+    CounterRng(std::uint64_t seed, std::uint64_t index, std::uint32_t purpose) : seed(seed), index(index), purpose(purpose) {}
+
+    std::uint64_t next64() {
+        if (used == 2) {
+            block = philox({std::uint32_t(index), std::uint32_t(index >> 32), purpose, counter++}, seed);
+            used = 0;
+        }
+        std::uint64_t value = (std::uint64_t)block[2 * used] << 32 | block[2 * used + 1];
+        used++;
+        return value;
+    }
+
+    // Uniform on (0, 1), never exactly 0 or 1, with 53 bits.
+    double uniform() { return ((next64() >> 11) + 0.5) * 0x1.0p-53; }
+    double exponential(double rate) { return -std::log(uniform()) / rate; }
+    // Box-Muller makes normals in pairs; the second is kept for the next call.
+    double normal() {
+        if (has_spare) {
+            has_spare = false;
+            return spare;
+        }
+        double radius = std::sqrt(-2 * std::log(uniform()));
+        double angle = 2 * M_PI * uniform();
+        spare = radius * std::sin(angle);
+        has_spare = true;
+        return radius * std::cos(angle);
+    }
+
+private:
+    std::uint64_t seed;
+    std::uint64_t index;
+    std::uint32_t purpose;
+    std::uint32_t counter = 0;
+    std::array<std::uint32_t, 4> block{};
+    int used = 2;
+    double spare = 0;
+    bool has_spare = false;
+};
+
+// What --random generates, parsed from the command line:
+//   arrivals    poisson:RATE, or mmpp:LOW,HIGH,SOJOURN for a two-state
+//               Markov-modulated Poisson process whose rate flips between LOW
+//               and HIGH after a mean of SOJOURN time units
+//   bursts      lognormal:MU,SIGMA (of the log), pareto:ALPHA,MIN, or
+//               bimodal:SHORT,LONG,P (medians of two narrow lognormals, the
+//               short one taken with probability P)
+//   priorities  PRIORITY:WEIGHT,... mix
+struct WorkloadSpec {
+    enum class Arrivals { Poisson, MMPP } arrivals = Arrivals::Poisson;
+    double rates[2] = {0.25, 0.25};
+    double sojourn = 0;
+    enum class Bursts { Lognormal, Pareto, Bimodal } bursts = Bursts::Lognormal;
+    double burst_params[3] = {1.3, 0.6, 0};
+    std::vector<int> priorities = {1, 2, 3, 4, 5};
+    std::vector<double> priority_cdf = {0.2, 0.4, 0.6, 0.8, 1.0};
+    std::uint64_t seed = 1;
+};
+
+// Parses "NAME:V1,V2,..." into its name and values; unparsable values make
+// the list empty, which every caller rejects.
+std::pair<std::string, std::vector<double>> parseDistribution(const std::string& text) {
+    size_t colon = text.find(':');
+    std::vector<double> values;
+    try {
+        for (const auto& v : splitList(colon == std::string::npos ? "" : text.substr(colon + 1))) values.push_back(std::stod(v));
+    } catch (const std::logic_error&) {
+        values.clear();
+    }
+    return {text.substr(0, colon), values};
+}
+
+// The parsers throw std::invalid_argument on a malformed description.
+void parseArrivals(WorkloadSpec& spec, const std::string& text) {
+    auto [name, v] = parseDistribution(text);
+    if (name == "poisson" && v.size() == 1 && v[0] > 0) {
+        spec.arrivals = WorkloadSpec::Arrivals::Poisson;
+        spec.rates[0] = spec.rates[1] = v[0];
+    } else if (name == "mmpp" && v.size() == 3 && v[0] > 0 && v[1] > 0 && v[2] > 0) {
+        spec.arrivals = WorkloadSpec::Arrivals::MMPP;
+        spec.rates[0] = v[0];
+        spec.rates[1] = v[1];
+        spec.sojourn = v[2];
+    } else {
+        throw std::invalid_argument("bad --arrivals " + text);
+    }
+}
+
+void parseBursts(WorkloadSpec& spec, const std::string& text) {
+    auto [name, v] = parseDistribution(text);
+    if (name == "lognormal" && v.size() == 2 && v[1] >= 0) {
+        spec.bursts = WorkloadSpec::Bursts::Lognormal;
+    } else if (name == "pareto" && v.size() == 2 && v[0] > 0 && v[1] > 0) {
+        spec.bursts = WorkloadSpec::Bursts::Pareto;
+    } else if (name == "bimodal" && v.size() == 3 && v[0] > 0 && v[1] > 0 && v[2] >= 0 && v[2] <= 1) {
+        spec.bursts = WorkloadSpec::Bursts::Bimodal;
+    } else {
+        throw std::invalid_argument("bad --bursts " + text);
+    }
+    std::copy(v.begin(), v.end(), spec.burst_params);
+}
+
+void parsePriorities(WorkloadSpec& spec, const std::string& text) {
+    std::vector<int> priorities;
+    std::vector<double> cdf;
+    double total = 0;
+    bool negative = false;
+    try {
+        for (const auto& item : splitList(text)) {
+            size_t colon = item.find(':');
+            double weight = colon == std::string::npos ? 1 : std::stod(item.substr(colon + 1));
+            negative |= weight < 0;
+            priorities.push_back(std::stoi(item.substr(0, colon)));
+            total += weight;
+            cdf.push_back(total);
+        }
+    } catch (const std::logic_error&) {
+        priorities.clear();
+    }
+    if (priorities.empty() || negative || !(total > 0)) {
+        throw std::invalid_argument("bad --priorities " + text);
+    }
+    for (auto& c : cdf) c /= total;
+    spec.priorities = priorities;
+    spec.priority_cdf = cdf;
+}
+
+struct GeneratedJob {
+    SimTime arrival;
+    SimTime burst;
+    int priority;
+};
+
+// Generates a WorkloadSpec in fixed windows of simulated time, each sized for
+// about WINDOW_JOBS arrivals at the highest rate. A window's jobs depend only
+// on the seed, the window index and its MMPP state, and come out in arrival
+// order: exponential gaps from the window start until the window end are
+// exactly a Poisson process there. The MMPP state is a Markov chain over
+// windows, one draw per window, so seeking to time T costs T / width draws
+// rather than generating every earlier job.
+class WorkloadGenerator {
+public:
+    static constexpr double WINDOW_JOBS = 4096;
+    enum Purpose : std::uint32_t { STATE = 1, JOBS = 2 };
+
+    explicit WorkloadGenerator(const WorkloadSpec& spec) : spec(spec) {
+        width = std::max<SimTime>(1, (SimTime)std::ceil(WINDOW_JOBS / std::max(spec.rates[0], spec.rates[1])));
+        switch_probability = spec.arrivals == WorkloadSpec::Arrivals::MMPP ? 1 - std::exp(-width / spec.sojourn) : 0;
+    }
+
+    SimTime windowWidth() const { return width; }
+
+    // The MMPP state of window 0, then of each window from the one before.
+    int firstState() const { return CounterRng(spec.seed, 0, STATE).uniform() < 0.5 ? 0 : 1; }
+    int nextState(std::uint64_t window, int state) const {
+        if (switch_probability == 0) return state;
+        return CounterRng(spec.seed, window + 1, STATE).uniform() < switch_probability ? 1 - state : state;
+    }
+
+    int stateAt(std::uint64_t window) const {
+        int state = firstState();
+        for (std::uint64_t k = 0; k < window; ++k) state = nextState(k, state);
+        return state;
+    }
+
+    void window(std::uint64_t index, int state, std::vector<GeneratedJob>& jobs) const {
+        jobs.clear();
+        CounterRng rng(spec.seed, index, JOBS);
+        const double rate = spec.rates[state];
+        const double end = (double)(index + 1) * width;
+        double t = (double)index * width;
+        while ((t += rng.exponential(rate)) < end) {
+            jobs.push_back({(SimTime)t, burst(rng), priority(rng)});
+        }
+    }
+
+private:
+    SimTime burst(CounterRng& rng) const {
+        const double* v = spec.burst_params;
+        double b = 0;
+        switch (spec.bursts) {
+            case WorkloadSpec::Bursts::Lognormal:
+                b = std::exp(v[0] + v[1] * rng.normal());
+                break;
+            case WorkloadSpec::Bursts::Pareto:
+                b = v[1] / std::pow(rng.uniform(), 1 / v[0]);
+                break;
+            case WorkloadSpec::Bursts::Bimodal:
+                b = (rng.uniform() < v[2] ? v[0] : v[1]) * std::exp(0.25 * rng.normal());
+                break;
+        }
+        return (SimTime)std::clamp(std::round(b), 1.0, 0x1.0p40);
+    }
+
+    int priority(CounterRng& rng) const {
+        if (spec.priorities.size() == 1) return spec.priorities[0];
+        double u = rng.uniform();
+        size_t i = std::lower_bound(spec.priority_cdf.begin(), spec.priority_cdf.end(), u) - spec.priority_cdf.begin();
+        return spec.priorities[std::min(i, spec.priorities.size() - 1)];
+    }
+
+    WorkloadSpec spec;
+    SimTime width;
+    double switch_probability;
+};
+
+// Streams a generated workload as a trace: `count` jobs named P1, P2, ... in
+// arrival order, starting at time `from`. Worker threads fill a ring of
+// windows ahead of the reader; window order and contents don't depend on
+// which worker made them, so the trace is the same for any thread count.
+class GeneratedTraceReader : public TraceReader {
+public:
+    GeneratedTraceReader(const WorkloadGenerator& generator, size_t count, SimTime from, size_t threads)
+        : generator(generator), remaining(count), from(from), ring(2 * std::max<size_t>(1, threads)) {
+        std::uint64_t first = from / generator.windowWidth();
+        consumed = next_claim = first;
+        claim_state = generator.stateAt(first);
+        for (size_t w = 0; w < std::max<size_t>(1, threads); ++w) workers.emplace_back([this] { work(); });
+    }
+
+    ~GeneratedTraceReader() override {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        drained.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    bool next(std::string& id, Process& p) override {
+        while (remaining > 0) {
+            if (!current) current = await(consumed);
+            if (position < current->jobs.size()) {
+                const GeneratedJob& job = current->jobs[position++];
+                if (job.arrival < from) continue;
+                remaining--;
+                char name[24] = {'P'};
+                id.assign(name, std::to_chars(name + 1, name + sizeof(name), ++emitted).ptr);
+                p = Process{0, job.arrival, job.burst, job.priority};
+                return true;
+            }
+            release();
+        }
+        return false;
+    }
+
+private:
+    struct Window {
+        std::vector<GeneratedJob> jobs;
+        bool ready = false;
+    };
+
+    Window* await(std::uint64_t index) {
+        Window& window = ring[index % ring.size()];
+        std::unique_lock<std::mutex> guard(lock);
+        filled.wait(guard, [&] { return window.ready; });
+        return &window;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            current->ready = false;
+            consumed++;
+        }
+        drained.notify_all();
+        current = nullptr;
+        position = 0;
+    }
+
+    void work() {
+        for (;;) {
+            std::uint64_t index;
+            int state;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                drained.wait(guard, [&] { return stopping || next_claim < consumed + ring.size(); });
+                if (stopping) return;
+                index = next_claim++;
+                state = claim_state;
+                claim_state = generator.nextState(index, state);
+            }
+            Window& window = ring[index % ring.size()];
+            generator.window(index, state, window.jobs);
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                window.ready = true;
+            }
+            filled.notify_all();
+        }
+    }
+
+    const WorkloadGenerator& generator;
+    size_t remaining;
+    SimTime from;
+    std::uint64_t emitted = 0;
+    std::vector<Window> ring;
+    Window* current = nullptr;
+    size_t position = 0;
+
+    std::mutex lock;
+    std::condition_variable filled;
+    std::condition_variable drained;
+    std::uint64_t consumed;
+    std::uint64_t next_claim;
+    int claim_state;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+};
+
+std::vector<Process> generateRandomProcesses(const WorkloadSpec& spec, size_t num, SimTime from, size_t threads, ProcessNames& names) {
+    WorkloadGenerator generator(spec);
+    GeneratedTraceReader reader(generator, num, from, threads);
+    std::vector<Process> processes;
+    processes.reserve(num);
+    std::string id;
+    Process p{};
+    while (reader.next(id, p)) {
+        p.pid = names.intern(id);
+        processes.push_back(p);
+    }
+    return processes;
+}
+
+// Everything a scheduler can be configured with from the command line.
+struct SchedulerOptions {
+    int quantum = 4;
+    SimTime sched_latency = 6;
+    SimTime min_granularity = 1;
+    ReadySelect select = ReadySelect::Heap;
+    std::uint64_t seed = 0;
+    std::vector<SimTime> mlfq_quanta = {2, 4, 8};
+    std::vector<SimTime> mlfq_allotments;  // per level; missing or 0 means one quantum
+    SimTime mlfq_boost = 0;                // 0 never boosts
+};
+
+// The scheduler named `type`, or nullptr if there is none by that name.
+std::unique_ptr<Scheduler> makeScheduler(const std::string& type, const SchedulerOptions& options) {
+    if (type == "rr") return std::make_unique<RoundRobinScheduler>(options.quantum);
+    if (type == "fcfs") return std::make_unique<FCFSScheduler>();
+    if (type == "sjf") return std::make_unique<SJFScheduler>(options.select);
+    if (type == "srtf") return std::make_unique<SRTFScheduler>(options.select);
+    if (type == "priority") return std::make_unique<PriorityScheduler>(options.select);
+    if (type == "cfs") return std::make_unique<CFSScheduler>(options.sched_latency, options.min_granularity);
+    if (type == "mlq") return std::make_unique<MLQScheduler>(options.quantum);
+    if (type == "mlfq") return std::make_unique<MLFQScheduler>(options.mlfq_quanta, options.mlfq_allotments, options.mlfq_boost);
+    if (type == "lottery") return std::make_unique<LotteryScheduler>(options.quantum, options.seed);
+    if (type == "edf") return std::make_unique<EDFScheduler>();
+    return nullptr;
+}
+
+// What the CPU should do from `start` on: run `pid`, or idle if pid is IDLE,
+// until `until`, the policy's next decision point. That is the end of the
+// slice, the next known arrival for preemptive policies, or NEVER when idle
+// with nothing pending.
+struct Decision {
+    static constexpr std::uint32_t IDLE = std::numeric_limits<std::uint32_t>::max();
+    static constexpr SimTime NEVER = std::numeric_limits<SimTime>::max();
+
+    std::uint32_t pid = IDLE;
+    SimTime start = 0;
+    SimTime until = NEVER;
+};
+
+// Incremental interface to a policy, for driving it from a live control loop
+// instead of a batch run. Time only moves forward, through advanceTo(), which
+// carries out the policy's decisions up to the new time. Jobs are keyed by a
+// pid the caller picks and may reuse once the job is done. A job's burst is
+// an estimate: it completes when the estimate runs out unless complete() ends
+// it first, and its metrics count the CPU time it actually got.
+class OnlineScheduler {
+public:
+    virtual ~OnlineScheduler() = default;
+
+    // Queues `job` to arrive at its arrival time or now, whichever is later.
+    // False if a job with its pid is still live.
+    virtual bool submit(const Process& job) = 0;
+    // Runs the policy up to `t`. False if `t` is in the past.
+    virtual bool advanceTo(SimTime t) = 0;
+    // What runs from now. Preemptive policies reconsider the running job
+    // here, so ask again after submitting.
+    virtual Decision nextDecision() = 0;
+    // Ends the running job `pid` now. False if `pid` isn't the one running.
+    virtual bool complete(std::uint32_t pid) = 0;
+
+    SimTime now() const { return current_time; }
+    size_t live() const { return live_jobs; }
+    const RunMetrics& metrics() const { return run_metrics; }
+    // Moves the pids of jobs done since the last call into `out`, in completion order.
+    void takeFinished(std::vector<std::uint32_t>& out) {
+        out.clear();
+        out.swap(finished);
+    }
+
+protected:
+    SimTime current_time = 0;
+    size_t live_jobs = 0;
+    RunMetrics run_metrics;
+    std::vector<std::uint32_t> finished;
 };
 
-class FCFSScheduler : public Scheduler {
+// Submitted jobs, in slots that are reused once a job is done. Jobs due later
+// wait in a heap by (arrival, submission order); a timer wheel won't do, since
+// a submission may arrive before a time the wheel has already peeked at.
+class OnlineFeed final : public ProcessFeed {
 public:
-    void schedule(std::vector<Process>& processes, std::vector<std::pair<std::string, int>>& gantt, int& total_time) override {
-        std::sort(processes.begin(), processes.end(), [](const Process& a, const Process& b){
-            return a.arrival_time < b.arrival_time;
-        });
+    explicit OnlineFeed(RunMetrics& metrics) : metrics(metrics) { slots = &pool; }
 
-        int current_time = 0;
-        for (auto& p : processes) {
-            if (current_time < p.arrival_time) {
-                current_time = p.arrival_time;
-            }
-            p.waiting_time = current_time - p.arrival_time;
-            current_time += p.burst_time;
-            p.turnaround_time = current_time - p.arrival_time;
-            gantt.push_back({p.id, p.burst_time});
+    bool hasNext() const override { return !pending.empty(); }
+    SimTime nextArrival() const override { return pending.front().arrival; }
+    int admit() override {
+        std::pop_heap(pending.begin(), pending.end(), later);
+        int slot = pending.back().slot;
+        pending.pop_back();
+        prepare(pool[slot], admitted++);
+        return slot;
+    }
+    void retire(int slot) override {
+        metrics.add(pool[slot]);
+        free_slots.push_back(slot);
+    }
+
+    // Stores `job` and schedules its arrival; returns its slot.
+    int stage(const Process& job) {
+        int slot;
+        if (free_slots.empty()) {
+            slot = pool.size();
+            pool.push_back(job);
+        } else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+            pool[slot] = job;
         }
-        total_time = current_time;
+        pending.push_back({job.arrival_time, staged++, slot});
+        std::push_heap(pending.begin(), pending.end(), later);
+        return slot;
+    }
+
+private:
+    struct Pending {
+        SimTime arrival;
+        std::uint64_t seq;
+        int slot;
+    };
+    static bool later(const Pending& a, const Pending& b) {
+        return a.arrival != b.arrival ? a.arrival > b.arrival : a.seq > b.seq;
     }
+
+    RunMetrics& metrics;
+    std::vector<Process> pool;
+    std::vector<int> free_slots;
+    std::vector<Pending> pending;
+    std::uint64_t staged = 0;
+    std::uint64_t admitted = 0;
 };
 
-class SJFScheduler : public Scheduler {
+// The engine's policies behind the online interface. Driving it with
+// nextDecision() and advanceTo(decision.until) reproduces the batch run of
+// the same policy. The running job is kept out of the ready queue and goes
+// back in when its slice ends, so submissions can be admitted at any time.
+template <typename ReadyQueue, typename Preemption, typename TimeSlice>
+class OnlineEngine : public OnlineScheduler {
 public:
-    void schedule(std::vector<Process>& processes, std::vector<std::pair<std::string, int>>& gantt, int& total_time) override {
-         for(auto& p : processes) p.remaining_time = p.burst_time;
-        
-        int current_time = 0;
-        int completed = 0;
-        while(completed < processes.size()){
-            int shortest_idx = -1;
-            int shortest_burst = 1e9;
+    explicit OnlineEngine(TimeSlice time_slice = TimeSlice())
+        : feed(run_metrics), ready(feed), slice(time_slice, feed.memory()) {}
 
-            for(int i=0; i<processes.size(); ++i){
-                if(processes[i].arrival_time <= current_time && processes[i].remaining_time > 0 && processes[i].burst_time < shortest_burst){
-                    shortest_burst = processes[i].burst_time;
-                    shortest_idx = i;
-                }
-            }
+    bool submit(const Process& job) override {
+        if (job.pid < slot_of.size() && slot_of[job.pid] != -1) return false;
+        if (job.pid >= slot_of.size()) slot_of.resize(job.pid + 1, -1);
+        Process p = job;
+        p.arrival_time = std::max(p.arrival_time, current_time);
+        slot_of[p.pid] = feed.stage(p);
+        live_jobs++;
+        admitDue();
+        return true;
+    }
 
-            if(shortest_idx == -1){
-                current_time++;
+    bool advanceTo(SimTime t) override {
+        if (t < current_time) return false;
+        while (true) {
+            admitDue();
+            if (running == -1 && !ready.empty()) dispatch();
+            if (running == -1) {
+                SimTime next = feed.hasNext() ? feed.nextArrival() : t;
+                if (next >= t) break;
+                current_time = next;
                 continue;
             }
-
-            Process& p = processes[shortest_idx];
-            current_time += p.burst_time;
-            p.remaining_time = 0;
-            p.turnaround_time = current_time - p.arrival_time;
-            p.waiting_time = p.turnaround_time - p.burst_time;
-            gantt.push_back({p.id, p.burst_time});
-            completed++;
+            SimTime until = decisionPoint();
+            SimTime stop = std::min(until, t);
+            Process& p = feed[running];
+            p.remaining_time -= stop - current_time;
+            current_time = stop;
+            if (p.remaining_time == 0) {
+                finish();
+            } else if (current_time == until) {
+                yield();
+            }
+            if (current_time == t) break;
         }
-        total_time = current_time;
+        current_time = t;
+        admitDue();
+        return true;
     }
-};
 
-class SRTFScheduler : public Scheduler {
-public:
-    void schedule(std::vector<Process>& processes, std::vector<std::pair<std::string, int>>& gantt, int& total_time) override {
-        for(auto& p : processes) p.remaining_time = p.burst_time;
+    Decision nextDecision() override {
+        admitDue();
+        if (preemptive && running != -1 && !ready.empty()) yield();
+        if (running == -1 && !ready.empty()) dispatch();
+        if (running == -1) return {Decision::IDLE, current_time, feed.hasNext() ? feed.nextArrival() : Decision::NEVER};
+        return {feed[running].pid, current_time, decisionPoint()};
+    }
 
-        int current_time = 0;
-        int completed = 0;
-        std::string last_id = "";
+    bool complete(std::uint32_t pid) override {
+        if (running == -1 || feed[running].pid != pid) return false;
+        Process& p = feed[running];
+        p.burst_time -= p.remaining_time;
+        p.remaining_time = 0;
+        finish();
+        return true;
+    }
 
-        while(completed < processes.size()){
-            int shortest_idx = -1;
-            int shortest_rem = 1e9;
+private:
+    static constexpr bool preemptive = std::is_same_v<Preemption, PreemptOnArrival>;
 
-            for(int i=0; i<processes.size(); ++i){
-                if(processes[i].arrival_time <= current_time && processes[i].remaining_time > 0 && processes[i].remaining_time < shortest_rem){
-                    shortest_rem = processes[i].remaining_time;
-                    shortest_idx = i;
-                }
-            }
+    void admitDue() {
+        while (feed.hasNext() && feed.nextArrival() <= current_time) ready.push(feed.admit());
+    }
 
-            if(shortest_idx == -1){
-                current_time++;
-                continue;
-            }
-            
-            Process& p = processes[shortest_idx];
+    void dispatch() {
+        running = ready.next();
+        ready.finish();
+        Process& p = feed[running];
+        markDispatched(p, current_time);
+        slice_end = current_time + slice.limit(p);
+    }
 
-            if(gantt.empty() || gantt.back().first != p.id) {
-                gantt.push_back({p.id, 1});
-            } else {
-                gantt.back().second++;
-            }
+    SimTime decisionPoint() { return current_time + Preemption::limit(feed, slice_end - current_time, current_time); }
 
-            p.remaining_time--;
-            current_time++;
+    // Back into the ready queue, behind anything that arrived during the slice.
+    void yield() {
+        admitDue();
+        ready.push(running);
+        running = -1;
+    }
 
-            if(p.remaining_time == 0){
-                completed++;
-                p.turnaround_time = current_time - p.arrival_time;
-                p.waiting_time = p.turnaround_time - p.burst_time;
-            }
-        }
-        total_time = current_time;
+    void finish() {
+        Process& p = feed[running];
+        p.turnaround_time = current_time - p.arrival_time;
+        p.waiting_time = p.turnaround_time - p.burst_time;
+        slot_of[p.pid] = -1;
+        finished.push_back(p.pid);
+        live_jobs--;
+        feed.retire(running);
+        running = -1;
     }
+
+    OnlineFeed feed;
+    ReadyQueue ready;
+    TimeSlice slice;
+    std::vector<int> slot_of;  // pid -> slot, -1 once done
+    int running = -1;
+    SimTime slice_end = 0;
 };
 
-class PriorityScheduler : public Scheduler {
-public:
-    void schedule(std::vector<Process>& processes, std::vector<std::pair<std::string, int>>& gantt, int& total_time) override {
-        for(auto& p : processes) p.remaining_time = p.burst_time;
-        
-        int current_time = 0;
-        int completed = 0;
-        while(completed < processes.size()){
-            int highest_priority_idx = -1;
-            int highest_priority = 1e9;
+// The policies with an online form; nullptr for the others, whose state
+// doesn't fit one ready queue.
+std::unique_ptr<OnlineScheduler> makeOnlineScheduler(const std::string& type, const SchedulerOptions& options) {
+    if (type == "fcfs") return std::make_unique<OnlineEngine<FifoQueue, NonPreemptive, RunToCompletion>>();
+    if (type == "sjf") return std::make_unique<OnlineEngine<KeyedQueue<BurstKey>, NonPreemptive, RunToCompletion>>();
+    if (type == "srtf") return std::make_unique<OnlineEngine<KeyedQueue<RemainingKey>, PreemptOnArrival, RunToCompletion>>();
+    if (type == "priority") return std::make_unique<OnlineEngine<KeyedQueue<PriorityKey>, NonPreemptive, RunToCompletion>>();
+    if (type == "rr") return std::make_unique<OnlineEngine<FifoQueue, NonPreemptive, FixedQuantum>>(FixedQuantum(options.quantum));
+    if (type == "edf") return std::make_unique<OnlineEngine<KeyedQueue<DeadlineKey>, PreemptOnArrival, RunToCompletion>>();
+    return nullptr;
+}
 
-            for(int i=0; i<processes.size(); ++i){
-                if(processes[i].arrival_time <= current_time && processes[i].remaining_time > 0 && processes[i].priority < highest_priority){
-                    highest_priority = processes[i].priority;
-                    highest_priority_idx = i;
-                }
-            }
+// Fixed set of tasks run by a pool of workers. Each worker starts with its own
+// share of the tasks, works from the back of its deque and, once that is empty,
+// steals from the front of the others'. Tasks don't spawn tasks, so a worker
+// that finds every deque empty is done.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t threads) : queues(std::max<size_t>(1, threads)) {}
 
-            if(highest_priority_idx == -1){
-                current_time++;
-                continue;
-            }
+    size_t threads() const { return queues.size(); }
 
-            Process& p = processes[highest_priority_idx];
-            current_time += p.burst_time;
-            p.remaining_time = 0;
-            p.turnaround_time = current_time - p.arrival_time;
-            p.waiting_time = p.turnaround_time - p.burst_time;
-            gantt.push_back({p.id, p.burst_time});
-            completed++;
+    // Calls task(worker, index) once for every index in [0, count).
+    void run(size_t count, const std::function<void(size_t, size_t)>& task) {
+        for (size_t i = 0; i < count; ++i) {
+            queues[i % queues.size()].tasks.push_back(i);
         }
-        total_time = current_time;
+        std::vector<std::thread> workers;
+        for (size_t w = 0; w < queues.size(); ++w) {
+            workers.emplace_back([this, w, &task] {
+                size_t index;
+                while (take(w, index)) task(w, index);
+            });
+        }
+        for (auto& worker : workers) worker.join();
     }
-};
 
-class RoundRobinScheduler : public Scheduler {
 private:
-    int quantum;
-public:
-    RoundRobinScheduler(int q) : quantum(q) {}
-    void schedule(std::vector<Process>& processes, std::vector<std::pair<std::string, int>>& gantt, int& total_time) override {
-         for (auto& p : processes) p.remaining_time = p.burst_time;
-        std::queue<Process*> ready_queue;
-        int current_time = 0;
-        int idx = 0;
-        int completed = 0;
+    struct Queue {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
 
-        while (completed < processes.size()) {
-            while (idx < processes.size() && processes[idx].arrival_time <= current_time) {
-                ready_queue.push(&processes[idx++]);
+    bool take(size_t worker, size_t& index) {
+        {
+            Queue& own = queues[worker];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                index = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
             }
-
-            if (ready_queue.empty()) {
-                if (idx < processes.size()) {
-                    current_time = processes[idx].arrival_time;
-                } else {
-                    break;
-                }
-                continue;
+        }
+        for (size_t k = 1; k < queues.size(); ++k) {
+            Queue& victim = queues[(worker + k) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                index = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
             }
+        }
+        return false;
+    }
 
-            Process* current = ready_queue.front();
-            ready_queue.pop();
+    std::vector<Queue> queues;
+};
 
-            int run_time = std::min(quantum, current->remaining_time);
-            
-            if (gantt.empty() || gantt.back().first != current->id) {
-                gantt.push_back({current->id, run_time});
-            } else {
-                gantt.back().second += run_time;
-            }
+struct SweepCell {
+    std::string scheduler;
+    int quantum;
+    std::uint64_t seed;
+    RunMetrics metrics;
+    SimTime total_time = 0;
+    OverheadMeter overhead;
+};
 
-            current->remaining_time -= run_time;
-            current_time += run_time;
+// Runs every cell against one shared, read-only workload. Each worker copies
+// the workload into its own scratch vector per cell and reuses its own arena
+// for the run's queues, and each cell writes only its own result, so the table
+// doesn't depend on the thread count. Given a snapshot, every cell is a branch
+// resumed from it instead of a run from zero. Each cell is charged `costs`.
+void runSweep(const std::vector<Process>& processes, std::vector<SweepCell>& cells, const SchedulerOptions& base,
+              const DispatchCosts& costs, size_t threads, const SimSnapshot* from = nullptr) {
+    WorkStealingPool pool(threads);
+    std::vector<std::vector<Process>> scratch(pool.threads());
+    std::vector<Gantt> gantts(pool.threads());
+    std::vector<RunArena> arenas(pool.threads());
+    const std::vector<int> order = from ? arrivalOrder(processes) : std::vector<int>();
+    pool.run(cells.size(), [&](size_t worker, size_t index) {
+        SweepCell& cell = cells[index];
+        SchedulerOptions options = base;
+        options.quantum = cell.quantum;
+        options.seed = cell.seed;
+        std::unique_ptr<Scheduler> scheduler = makeScheduler(cell.scheduler, options);
+        cell.overhead = OverheadMeter(costs);
+        gantts[worker].meterTo(costs.enabled() ? &cell.overhead : nullptr);
 
-            while (idx < processes.size() && processes[idx].arrival_time <= current_time) {
-                ready_queue.push(&processes[idx++]);
-            }
+        if (from) {
+            Gantt& gantt = gantts[worker];
+            gantt.clear();
+            BranchFeed feed(processes, order, *from, std::numeric_limits<SimTime>::max(), gantt, cell.metrics);
+            scheduler->run(feed, gantt, cell.total_time);
+            return;
+        }
+        std::vector<Process>& local = scratch[worker];
+        local.assign(processes.begin(), processes.end());
+        Gantt& gantt = gantts[worker];
+        gantt.clear();
+        scheduler->schedule(local, gantt, cell.total_time, arenas[worker].reset());
+        cell.metrics = collectMetrics(local);
+    });
+}
 
-            if (current->remaining_time > 0) {
-                ready_queue.push(current);
-            } else {
-                current->turnaround_time = current_time - current->arrival_time;
-                current->waiting_time = current->turnaround_time - current->burst_time;
-                completed++;
-            }
+// With `metered`, each row also gives the cell's context switches, overhead
+// time and effective utilization and throughput (see printOverhead()).
+void printSweep(std::ostream& out, const std::vector<SweepCell>& cells, bool metered) {
+    out << "scheduler\tquantum\tseed\tavg_wait\tavg_turnaround\tcpu_util\tthroughput\tp99_wait\tp99_response";
+    out << (metered ? "\tswitches\toverhead\teffective_util\teffective_throughput\n" : "\n");
+    for (const auto& cell : cells) {
+        double avg_wait, avg_turn, cpu_util, throughput;
+        calculateMetrics(cell.metrics, cell.total_time, avg_wait, avg_turn, cpu_util, throughput);
+        out << cell.scheduler << "\t" << cell.quantum << "\t" << cell.seed << "\t" << avg_wait << "\t"
+            << avg_turn << "\t" << cpu_util << "\t" << throughput << "\t" << cell.metrics.latency.waiting.percentile(0.99)
+            << "\t" << cell.metrics.latency.response.percentile(0.99);
+        if (metered) {
+            double effective_time;
+            effectiveMetrics(cell.metrics, cell.total_time, cell.overhead, effective_time, cpu_util, throughput);
+            out << "\t" << cell.overhead.switchCount() << "\t" << cell.overhead.overhead() << "\t" << cpu_util << "\t" << throughput;
         }
-        total_time = current_time;
+        out << "\n";
     }
-};
+}
 
-class MLQScheduler : public Scheduler {
-public:
-    void schedule(std::vector<Process>& processes, std::vector<std::pair<std::string, int>>& gantt, int& total_time) override {
-        // Not implemented in this version
+// Runs `scheduler` over `processes` from the start to the first decision at or
+// after `at`, and returns the state there.
+SimSnapshot runPrefix(Scheduler& scheduler, const std::vector<Process>& processes, const std::vector<int>& order, SimTime at) {
+    SimSnapshot start;
+    Gantt gantt;
+    RunMetrics metrics;
+    SimTime time = 0;
+    BranchFeed feed(processes, order, start, at, gantt, metrics);
+    scheduler.run(feed, gantt, time);
+    return feed.snapshot(gantt, time);
+}
+
+// A writer for `output_file`, or for stdout when it is empty; nullptr (after
+// reporting the error) if the file can't be opened.
+std::unique_ptr<ResultWriter> openOutput(const std::string& output_file) {
+    if (output_file.empty()) return std::make_unique<ResultWriter>(STDOUT_FILENO);
+    std::unique_ptr<ResultWriter> out = ResultWriter::open(output_file);
+    if (!out) std::cerr << "Error: Could not open output file " << output_file << "\n";
+    return out;
+}
+
+// Writes the run's results to `output_file`, or to stdout when it is empty,
+// with the overhead `meter` charged it, if any.
+int writeResults(const std::string& output_file, OutputFormat format, const RunMetrics& metrics, SimTime total_time, const Gantt& gantt,
+                 const ProcessNames& names, bool percentiles, const OverheadMeter* meter = nullptr) {
+    if (std::unique_ptr<ResultWriter> out = openOutput(output_file)) {
+        SegmentEncoder encoder(format, names);
+        printResults(*out, metrics, total_time, gantt, encoder, percentiles, meter);
     }
-};
-class MLFQScheduler : public Scheduler {
-public:
-    void schedule(std::vector<Process>& processes, std::vector<std::pair<std::string, int>>& gantt, int& total_time) override {
-        // Not implemented in this version
+    return 0;
+}
+
+// Runs `scheduler` over a trace read lazily from `reader`, spilling the Gantt
+// chart to a temporary file, already encoded in `format`, as it goes.
+int runStreaming(Scheduler& scheduler, TraceReader& reader, const std::string& output_file, OutputFormat format, bool record_gantt,
+                 bool percentiles, const DispatchCosts& costs) {
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> spill_file(std::tmpfile(), std::fclose);
+    if (!spill_file) {
+        std::cerr << "Error: Could not create Gantt spill file\n";
+        return 1;
     }
-};
-class LotteryScheduler : public Scheduler {
-public:
-    void schedule(std::vector<Process>& processes, std::vector<std::pair<std::string, int>>& gantt, int& total_time) override {
-        // Not implemented in this version
+    ResultWriter spill(fileno(spill_file.get()));
+    Gantt gantt;
+    if (!record_gantt) gantt.disable();
+    OverheadMeter meter(costs);
+    if (costs.enabled()) gantt.meterTo(&meter);
+    RunMetrics metrics;
+    SimTime total_time = 0;
+    TraceStreamFeed feed(reader, gantt, metrics);
+    SegmentEncoder spill_encoder(format, feed.slotNames());
+    gantt.spillTo(spill, spill_encoder);
+    scheduler.run(feed, gantt, total_time);
+    if (metrics.completed == 0) {
+        std::cerr << "No processes loaded.\n";
+        return 1;
     }
-};
-class CFSScheduler : public Scheduler {
+    std::unique_ptr<ResultWriter> out = openOutput(output_file);
+    if (!out) return 0;
+    // Segments still buffered are encoded after the spilled ones, so they must
+    // share the spill encoder's record of which names were already written.
+    printResults(*out, metrics, total_time, gantt, spill_encoder, percentiles, costs.enabled() ? &meter : nullptr);
+    return 0;
+}
+
+// Unbounded lock-free multi-producer, single-consumer queue (Vyukov's
+// node-based design). A push is one atomic exchange and a store, and only the
+// consumer touches the tail. pop() can miss an element whose push is half
+// done; it reports empty and the consumer tries again. A consumer with
+// nothing to take spins briefly, then sleeps until a producer wakes it.
+template <typename T>
+class MpscQueue {
 public:
-    void schedule(std::vector<Process>& processes, std::vector<std::pair<std::string, int>>& gantt, int& total_time) override {
-        // Not implemented in this version
+    MpscQueue() : head(&stub), tail(&stub) {}
+    ~MpscQueue() {
+        T value;
+        while (pop(value)) {}
     }
-};
-class EDFScheduler : public Scheduler {
-public:
-    void schedule(std::vector<Process>& processes, std::vector<std::pair<std::string, int>>& gantt, int& total_time) override {
-        // Not implemented in this version
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        enqueue(new Node(std::move(value)));
+        // Pairs with the fence in take(): either the consumer sees the new
+        // node, or this sees it asleep and wakes it.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> guard(lock);
+            wake.notify_one();
+        }
     }
-};
 
-std::vector<Process> loadProcesses(const std::string& filename) {
-    std::vector<Process> processes;
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "Error opening file: " << filename << "\n";
-        return processes;
+    // Consumer only. False if nothing is ready yet.
+    bool pop(T& value) {
+        Node* t = tail;
+        Node* next = t->next.load(std::memory_order_acquire);
+        if (t == &stub) {
+            if (!next) return false;
+            tail = t = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (!next && t == head.load(std::memory_order_acquire)) {
+            // `t` is the last node; put the stub behind it so it can be unlinked.
+            enqueue(&stub);
+            next = t->next.load(std::memory_order_acquire);
+        }
+        if (!next) return false;
+        tail = next;
+        value = std::move(t->value);
+        delete t;
+        return true;
+    }
+
+    // Consumer only. Waits for the next element.
+    T take() {
+        T value;
+        for (int spin = 0; spin < 4096; ++spin) {
+            if (pop(value)) return value;
+        }
+        std::unique_lock<std::mutex> guard(lock);
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!pop(value)) wake.wait(guard);
+        sleeping.store(false, std::memory_order_relaxed);
+        return value;
+    }
+
+private:
+    struct Node {
+        explicit Node(T value = T()) : value(std::move(value)) {}
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    void enqueue(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
     }
+
+    Node stub;
+    std::atomic<Node*> head;
+    Node* tail;
+    std::atomic<bool> sleeping{false};
+    std::mutex lock;
+    std::condition_variable wake;
+};
+
+struct ServiceClient;
+
+// One line of the service protocol, parsed by the producer thread that read
+// it, plus the connection bookkeeping messages. The scheduler thread runs
+// them in queue order, so each client's requests run in the order it sent them.
+struct ServiceRequest {
+    enum class Op { None, Submit, Advance, Next, Complete, Stats, Shutdown, Invalid, Open, Close, Stopped };
+    Op op = Op::None;
+    ServiceClient* client = nullptr;
+    int fd = -1;  // Open: the accepted connection
     std::string id;
-    int at, bt, pri;
-    while (file >> id >> at >> bt >> pri) {
-        processes.push_back({id, at, bt, pri});
+    Process job{};
+    SimTime time = 0;
+    std::string error;  // Invalid: what was wrong with the line
+};
+
+// One connection. Only its reader thread reads from it and only the
+// scheduler thread writes to it.
+struct ServiceClient {
+    ServiceClient(int in, int out, bool owned) : in(in), out(out, owned) {}
+    int in;
+    ResultWriter out;
+    std::thread reader;
+};
+
+// Parses one request line:
+//
+//   submit ID BURST [PRIORITY [DEADLINE [ARRIVAL]]]   queue a job (BURST is an estimate)
+//   advance T                                        run the policy up to time T
+//   next                                             what runs now, and until when
+//   complete ID                                      the running job ID finished now
+//   stats                                            metrics and decision latency so far
+//   shutdown                                         stop the service
+ServiceRequest parseServiceRequest(std::string_view line) {
+    using Op = ServiceRequest::Op;
+    ServiceRequest request;
+    std::array<std::string_view, 6> word;
+    size_t words = 0;
+    for (size_t i = 0; i < line.size();) {
+        if (std::isspace((unsigned char)line[i])) {
+            i++;
+            continue;
+        }
+        size_t end = i;
+        while (end < line.size() && !std::isspace((unsigned char)line[end])) end++;
+        if (words == word.size()) {
+            request.op = Op::Invalid;
+            request.error = "too many fields";
+            return request;
+        }
+        word[words++] = line.substr(i, end - i);
+        i = end;
     }
-    std::sort(processes.begin(), processes.end(), [](const Process& a, const Process& b) {
-        return a.arrival_time < b.arrival_time;
-    });
-    return processes;
+    if (words == 0) return request;
+
+    auto number = [](std::string_view text, auto& value) {
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return ec == std::errc() && end == text.data() + text.size();
+    };
+    auto invalid = [&](std::string error) {
+        request.op = Op::Invalid;
+        request.error = std::move(error);
+        return request;
+    };
+    std::string_view command = word[0];
+    if (command == "submit") {
+        if (words < 3) return invalid("usage: submit ID BURST [PRIORITY [DEADLINE [ARRIVAL]]]");
+        request.op = Op::Submit;
+        request.id = std::string(word[1]);
+        if (!number(word[2], request.job.burst_time) || request.job.burst_time <= 0) return invalid("bad burst");
+        if (words > 3 && !number(word[3], request.job.priority)) return invalid("bad priority");
+        if (words > 4 && (!number(word[4], request.job.deadline) || request.job.deadline < 0)) return invalid("bad deadline");
+        if (words > 5 && !number(word[5], request.job.arrival_time)) return invalid("bad arrival");
+    } else if (command == "advance") {
+        if (words != 2 || !number(word[1], request.time)) return invalid("usage: advance T");
+        request.op = Op::Advance;
+    } else if (command == "complete") {
+        if (words != 2) return invalid("usage: complete ID");
+        request.op = Op::Complete;
+        request.id = std::string(word[1]);
+    } else if (words == 1 && command == "next") {
+        request.op = Op::Next;
+    } else if (words == 1 && command == "stats") {
+        request.op = Op::Stats;
+    } else if (words == 1 && command == "shutdown") {
+        request.op = Op::Shutdown;
+    } else {
+        return invalid("unknown request: " + std::string(line));
+    }
+    return request;
 }
 
-std::vector<Process> generateRandomProcesses(int num) {
-    std::vector<Process> processes;
-    std::mt19937 gen(std::chrono::system_clock::now().time_since_epoch().count());
-    for (int i = 0; i < num; ++i) {
-        std::string id = "P" + std::to_string(i + 1);
-        int at = gen() % 20;
-        int bt = 1 + gen() % 10;
-        int pri = 1 + gen() % 5;
-        processes.push_back({id, at, bt, pri});
-    }
-    std::sort(processes.begin(), processes.end(), [](const Process& a, const Process& b) {
-        return a.arrival_time < b.arrival_time;
-    });
-    return processes;
+// Producer thread for one client: splits its input into lines, parses them
+// and queues them, then queues Close at end of input or after a shutdown.
+void readRequests(ServiceClient* client, MpscQueue<ServiceRequest>* queue) {
+    std::string pending;
+    char chunk[4096];
+    bool stop = false;
+    while (!stop) {
+        ssize_t n = ::read(client->in, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        pending.append(chunk, n);
+        size_t start = 0;
+        for (size_t newline; !stop && (newline = pending.find('\n', start)) != std::string::npos; start = newline + 1) {
+            ServiceRequest request = parseServiceRequest(std::string_view(pending).substr(start, newline - start));
+            if (request.op == ServiceRequest::Op::None) continue;
+            stop = request.op == ServiceRequest::Op::Shutdown;
+            request.client = client;
+            queue->push(std::move(request));
+        }
+        pending.erase(0, start);
+    }
+    ServiceRequest close;
+    close.op = ServiceRequest::Op::Close;
+    close.client = client;
+    queue->push(std::move(close));
 }
 
-int main(int argc, char* argv[]) {
-    std::map<std::string, std::string> args;
-    for (int i = 1; i < argc; i += 2) {
-        if (i + 1 < argc) {
-            args[argv[i]] = argv[i + 1];
+// Accepts connections on `listener` and hands them to the scheduler thread
+// until the listener is shut down.
+void acceptClients(int listener, MpscQueue<ServiceRequest>* queue) {
+    while (true) {
+        int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        ServiceRequest open;
+        open.op = ServiceRequest::Op::Open;
+        open.fd = fd;
+        queue->push(std::move(open));
+    }
+    ServiceRequest stopped;
+    stopped.op = ServiceRequest::Op::Stopped;
+    queue->push(std::move(stopped));
+}
+
+// A listening Unix domain socket at `path`, or -1. A stale socket left at the
+// path is replaced; any other file there is an error.
+int listenUnix(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) return -1;
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) ::unlink(path.c_str());
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 64) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Runs `scheduler` as a service on `endpoint`: "stdio" answers requests from
+// stdin on stdout and stops at end of input; "unix:PATH" listens on a Unix
+// domain socket, one reader thread per connection, until a client sends
+// shutdown. Every request runs on this thread, in arrival order, and replies
+// go back on the connection it came from:
+//
+//   submit    "ok", or "error ..." if the ID is still live
+//   advance   "done ID" per job finished on the way, then "ok NOW"
+//   next      "run ID START UNTIL" or "idle START UNTIL"; UNTIL may be "never"
+//   complete  "done ID" then "ok", or "error ..." if ID isn't running
+//   stats     one "stats name=value ..." line
+//
+// Replies are flushed whenever the queue runs dry, so a burst of pipelined
+// requests costs one write per client. Decision latency is the time spent
+// inside submit, next and complete calls, in nanoseconds; advance is left out,
+// since its cost grows with the simulated time it covers.
+int runService(const std::string& endpoint, OnlineScheduler& scheduler) {
+    using Op = ServiceRequest::Op;
+    MpscQueue<ServiceRequest> queue;
+    std::vector<ServiceClient*> clients;
+    std::vector<ServiceClient*> unflushed;
+    std::thread acceptor;
+    int listener = -1;
+    std::string socket_path;
+
+    auto connect = [&](int in, int out, bool owned) {
+        ServiceClient* client = new ServiceClient(in, out, owned);
+        clients.push_back(client);
+        client->reader = std::thread(readRequests, client, &queue);
+    };
+    if (endpoint == "stdio") {
+        connect(STDIN_FILENO, STDOUT_FILENO, false);
+    } else if (endpoint.rfind("unix:", 0) == 0) {
+        socket_path = endpoint.substr(5);
+        listener = listenUnix(socket_path);
+        if (listener < 0) {
+            std::cerr << "Error: Could not listen on " << socket_path << "\n";
+            return 1;
+        }
+        std::signal(SIGPIPE, SIG_IGN);
+        acceptor = std::thread(acceptClients, listener, &queue);
+    } else {
+        std::cerr << "Unknown service endpoint: " << endpoint << " (use stdio or unix:PATH)\n";
+        return 1;
+    }
+
+    // Job IDs map to pids that are recycled once a job is done.
+    std::unordered_map<std::string, std::uint32_t> pid_of;
+    std::vector<std::string> id_of;
+    std::vector<std::uint32_t> free_pids;
+    std::vector<std::uint32_t> done;
+    LatencyHistogram decision_ns;
+    bool stopping = false;
+
+    auto reportDone = [&](ResultWriter& out) {
+        scheduler.takeFinished(done);
+        for (std::uint32_t pid : done) {
+            out.put("done ");
+            out.put(id_of[pid]);
+            out.put('\n');
+            pid_of.erase(id_of[pid]);
+            free_pids.push_back(pid);
+        }
+    };
+    auto putTime = [](ResultWriter& out, SimTime t) {
+        if (t == Decision::NEVER) out.put("never");
+        else out.put(t);
+    };
+    auto stop = [&] {
+        stopping = true;
+        if (listener >= 0) ::shutdown(listener, SHUT_RDWR);
+        for (ServiceClient* client : clients) ::shutdown(client->in, SHUT_RD);
+    };
+
+    while (!clients.empty() || acceptor.joinable()) {
+        ServiceRequest request;
+        if (!queue.pop(request)) {
+            for (ServiceClient* client : unflushed) client->out.flush();
+            unflushed.clear();
+            request = queue.take();
+        }
+        switch (request.op) {
+        case Op::Open:
+            if (stopping) {
+                ::close(request.fd);
+            } else {
+                connect(request.fd, request.fd, true);
+            }
+            continue;
+        case Op::Stopped:
+            acceptor.join();
+            continue;
+        case Op::Close: {
+            ServiceClient* client = request.client;
+            client->reader.join();
+            unflushed.erase(std::remove(unflushed.begin(), unflushed.end(), client), unflushed.end());
+            clients.erase(std::find(clients.begin(), clients.end(), client));
+            delete client;
+            continue;
+        }
+        default:
+            break;
+        }
+
+        ResultWriter& out = request.client->out;
+        if (std::find(unflushed.begin(), unflushed.end(), request.client) == unflushed.end()) unflushed.push_back(request.client);
+        auto start = std::chrono::steady_clock::now();
+        auto elapsed = [&] {
+            decision_ns.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        };
+        switch (request.op) {
+        case Op::Submit: {
+            if (pid_of.count(request.id)) {
+                out.put("error ");
+                out.put(request.id);
+                out.put(" is still live\n");
+                break;
+            }
+            std::uint32_t pid;
+            if (free_pids.empty()) {
+                pid = id_of.size();
+                id_of.push_back(request.id);
+            } else {
+                pid = free_pids.back();
+                free_pids.pop_back();
+                id_of[pid] = request.id;
+            }
+            pid_of.emplace(request.id, pid);
+            request.job.pid = pid;
+            start = std::chrono::steady_clock::now();
+            scheduler.submit(request.job);
+            elapsed();
+            out.put("ok\n");
+            break;
+        }
+        case Op::Advance:
+            if (!scheduler.advanceTo(request.time)) {
+                out.put("error time is before ");
+                out.put(scheduler.now());
+                out.put('\n');
+                break;
+            }
+            reportDone(out);
+            out.put("ok ");
+            out.put(scheduler.now());
+            out.put('\n');
+            break;
+        case Op::Next: {
+            Decision decision = scheduler.nextDecision();
+            elapsed();
+            if (decision.pid == Decision::IDLE) {
+                out.put("idle ");
+            } else {
+                out.put("run ");
+                out.put(id_of[decision.pid]);
+                out.put(' ');
+            }
+            out.put(decision.start);
+            out.put(' ');
+            putTime(out, decision.until);
+            out.put('\n');
+            break;
+        }
+        case Op::Complete: {
+            auto it = pid_of.find(request.id);
+            if (it == pid_of.end() || !scheduler.complete(it->second)) {
+                out.put("error ");
+                out.put(request.id);
+                out.put(" is not running\n");
+                break;
+            }
+            elapsed();
+            reportDone(out);
+            out.put("ok\n");
+            break;
+        }
+        case Op::Stats: {
+            const RunMetrics& metrics = scheduler.metrics();
+            double done_jobs = std::max<std::uint64_t>(1, metrics.completed);
+            out.put("stats now=");
+            out.put(scheduler.now());
+            out.put(" live=");
+            out.put(scheduler.live());
+            out.put(" done=");
+            out.put(metrics.completed);
+            out.put(" avg_wait=");
+            out.put(metrics.total_waiting / done_jobs);
+            out.put(" avg_turnaround=");
+            out.put(metrics.total_turnaround / done_jobs);
+            out.put(" p99_response=");
+            out.put(metrics.latency.response.percentile(0.99));
+            out.put(" decision_ns_p50=");
+            out.put(decision_ns.percentile(0.5));
+            out.put(" decision_ns_p99=");
+            out.put(decision_ns.percentile(0.99));
+            out.put(" decision_ns_max=");
+            out.put(decision_ns.max());
+            out.put('\n');
+            break;
+        }
+        case Op::Shutdown:
+            out.put("ok\n");
+            stop();
+            break;
+        case Op::Invalid:
+            out.put("error ");
+            out.put(request.error);
+            out.put('\n');
+            break;
+        default:
+            break;
+        }
+    }
+    if (listener >= 0) {
+        ::close(listener);
+        ::unlink(socket_path.c_str());
+    }
+    return 0;
+}
+
+// The benchmark builds this file with SIMULATOR_NO_MAIN to reuse the schedulers.
+#ifndef SIMULATOR_NO_MAIN
+// Switches that take no value. One may still be followed by a value such as
+// "1", as older command lines pass, but never takes the next flag as one.
+constexpr std::string_view SWITCH_FLAGS[] = {"--analyze", "--no-gantt", "--percentiles", "--random", "--stream"};
+
+// Pairs each flag with the value after it, or "" for a switch. False, after
+// reporting why, on a stray value or a flag left without one.
+bool parseArgs(int argc, char* argv[], std::map<std::string, std::string>& args) {
+    auto isFlag = [](std::string_view word) { return word.substr(0, 2) == "--"; };
+    for (int i = 1; i < argc; ++i) {
+        std::string_view flag = argv[i];
+        if (!isFlag(flag)) {
+            std::cerr << "Error: unexpected argument " << flag << "\n";
+            return false;
+        }
+        bool has_value = i + 1 < argc && !isFlag(argv[i + 1]);
+        if (std::find(std::begin(SWITCH_FLAGS), std::end(SWITCH_FLAGS), flag) != std::end(SWITCH_FLAGS)) {
+            args[std::string(flag)] = has_value ? argv[++i] : "";
+        } else if (has_value) {
+            args[std::string(flag)] = argv[++i];
         } else {
-             args[argv[i]] = "";
+            std::cerr << "Error: " << flag << " needs a value\n";
+            return false;
         }
     }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::map<std::string, std::string> args;
+    if (!parseArgs(argc, argv, args)) return 1;
     std::string scheduler_type = args["--scheduler"];
     std::string input_file = args["--input"];
     std::string output_file = args["--output"];
-    int quantum = args.count("--quantum") ? std::stoi(args["--quantum"]) : 4;
+    SchedulerOptions options;
+    if (args.count("--quantum")) options.quantum = std::stoi(args["--quantum"]);
+    if (args.count("--sched-latency")) options.sched_latency = std::stoll(args["--sched-latency"]);
+    if (args.count("--min-granularity")) options.min_granularity = std::stoll(args["--min-granularity"]);
+    if (args.count("--seed")) options.seed = std::stoull(args["--seed"]);
+    // --mlfq-quanta and --mlfq-allotments list per-level values; --mlfq-levels
+    // extends the quanta by doubling the last one. --mlfq-boost sets the boost period.
+    if (args.count("--mlfq-quanta")) {
+        options.mlfq_quanta.clear();
+        for (const auto& q : splitList(args["--mlfq-quanta"])) options.mlfq_quanta.push_back(std::stoll(q));
+    }
+    for (const auto& a : splitList(args["--mlfq-allotments"])) options.mlfq_allotments.push_back(std::stoll(a));
+    if (args.count("--mlfq-levels")) {
+        size_t levels = std::min<size_t>(std::stoul(args["--mlfq-levels"]), MLFQ_MAX_LEVELS);
+        if (options.mlfq_quanta.empty()) options.mlfq_quanta.push_back(1);
+        while (options.mlfq_quanta.size() < levels) {
+            options.mlfq_quanta.push_back(std::min<SimTime>(options.mlfq_quanta.back() * 2, SimTime(1) << 40));
+        }
+        options.mlfq_quanta.resize(levels);
+    }
+    if (args.count("--mlfq-boost")) options.mlfq_boost = std::stoll(args["--mlfq-boost"]);
+    // --select scan swaps the SJF/SRTF/Priority heaps for SIMD linear scans.
+    if (args["--select"] == "scan") options.select = ReadySelect::Scan;
+    // --sweep runs every combination of the listed schedulers, --quanta and
+    // --seeds on --threads workers and prints one table.
+    std::vector<std::string> sweep = splitList(args["--sweep"]);
+    std::vector<std::string> sweep_quanta = splitList(args["--quanta"]);
+    std::vector<std::string> sweep_seeds = splitList(args["--seeds"]);
+    // --cpus N simulates N CPUs with per-CPU run queues; --balance-interval and
+    // --migration-cost tune load balancing between them.
+    size_t cpus = args.count("--cpus") ? std::stoul(args["--cpus"]) : 0;
+    SimTime balance_interval = args.count("--balance-interval") ? std::stoll(args["--balance-interval"]) : 4;
+    SimTime migration_cost = args.count("--migration-cost") ? std::stoll(args["--migration-cost"]) : 1;
+    // --switch-cost, --warmup with --warmup-decay, and --decision-cost charge
+    // dispatch overhead (see DispatchCosts) and report what it did to the run.
+    DispatchCosts costs;
+    if (args.count("--switch-cost")) costs.switch_cost = std::stod(args["--switch-cost"]);
+    if (args.count("--warmup")) costs.warmup = std::stod(args["--warmup"]);
+    if (args.count("--warmup-decay")) costs.warmup_decay = std::stod(args["--warmup-decay"]);
+    if (args.count("--decision-cost")) costs.decision_cost = std::stod(args["--decision-cost"]);
+    OverheadMeter meter(costs);
+    OverheadMeter* charged = costs.enabled() ? &meter : nullptr;
+    // --tasks reads a periodic task set ("id period wcet deadline offset") and
+    // releases its jobs over the hyperperiod, or --horizon units. --analyze
+    // only runs the EDF schedulability tests.
+    std::string tasks_file = args["--tasks"];
+    SimTime horizon = args.count("--horizon") ? std::stoll(args["--horizon"]) : 0;
+    bool analyze_only = args.count("--analyze");
+    size_t threads = args.count("--threads") ? std::stoul(args["--threads"]) : std::max(1u, std::thread::hardware_concurrency());
+    // --snapshot-at T --snapshot-file F runs --scheduler up to T and saves the
+    // state to F; --restore F resumes from it, with any --scheduler. --fork-at
+    // T with --sweep runs one shared prefix to T and every cell from there, as
+    // does --restore with --sweep.
+    SimTime snapshot_at = args.count("--snapshot-at") ? std::stoll(args["--snapshot-at"]) : -1;
+    SimTime fork_at = args.count("--fork-at") ? std::stoll(args["--fork-at"]) : -1;
+    std::string snapshot_file = args["--snapshot-file"];
+    std::string restore_file = args["--restore"];
+    // --stream reads an arrival-sorted --input trace lazily instead of loading it.
+    bool stream = args.count("--stream");
+    // --convert writes the --input trace to the given file in the binary format and exits.
+    std::string convert_file = args["--convert"];
+    // --format picks text (the default), csv or binary results; --no-gantt
+    // leaves the Gantt chart out and skips recording it, and --percentiles
+    // adds tail latencies, overall and per priority.
+    std::string format_name = args.count("--format") ? args["--format"] : "text";
+    OutputFormat format = OutputFormat::Text;
+    if (format_name == "csv") {
+        format = OutputFormat::CSV;
+    } else if (format_name == "binary") {
+        format = OutputFormat::Binary;
+    } else if (format_name != "text") {
+        std::cerr << "Unknown format: " << format_name << "\n";
+        return 1;
+    }
+    bool record_gantt = !args.count("--no-gantt");
+    bool percentiles = args.count("--percentiles");
+    // --random generates --num jobs from --workload-seed, shaped by --arrivals,
+    // --bursts and --priorities (see WorkloadSpec), starting at --random-from.
     bool random = args.count("--random");
-    int num_random = args.count("--num") ? std::stoi(args["--num"]) : 10;
+    size_t num_random = args.count("--num") ? std::stoull(args["--num"]) : 10;
+    SimTime random_from = args.count("--random-from") ? std::stoll(args["--random-from"]) : 0;
+    WorkloadSpec workload;
+    try {
+        if (args.count("--workload-seed")) workload.seed = std::stoull(args["--workload-seed"]);
+        if (args.count("--arrivals")) parseArrivals(workload, args["--arrivals"]);
+        if (args.count("--bursts")) parseBursts(workload, args["--bursts"]);
+        if (args.count("--priorities")) parsePriorities(workload, args["--priorities"]);
+    } catch (const std::logic_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (!convert_file.empty()) {
+        ProcessNames names;
+        std::vector<Process> processes = loadProcesses(input_file, names);
+        if (processes.empty()) {
+            std::cerr << "No processes loaded.\n";
+            return 1;
+        }
+        if (!writeBinaryTrace(convert_file, std::move(processes), names)) {
+            std::cerr << "Error: Could not write trace " << convert_file << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // --serve stdio|unix:PATH runs --scheduler as an online service (see runService).
+    if (args.count("--serve")) {
+        std::unique_ptr<OnlineScheduler> online = makeOnlineScheduler(scheduler_type, options);
+        if (!online) {
+            std::cerr << "Scheduler " << scheduler_type << " has no online mode (fcfs, sjf, srtf, priority, rr and edf do)\n";
+            return 1;
+        }
+        return runService(args["--serve"], *online);
+    }
+
+    std::vector<SweepCell> cells;
+    if (!sweep.empty()) {
+        if (sweep_quanta.empty()) sweep_quanta.push_back(std::to_string(options.quantum));
+        if (sweep_seeds.empty()) sweep_seeds.push_back(std::to_string(options.seed));
+        for (const auto& type : sweep) {
+            if (!makeScheduler(type, options)) {
+                std::cerr << "Unknown scheduler: " << type << "\n";
+                return 1;
+            }
+            for (const auto& q : sweep_quanta) {
+                for (const auto& seed : sweep_seeds) {
+                    cells.push_back({type, std::stoi(q), std::stoull(seed), {}, 0, {}});
+                }
+            }
+        }
+    }
+
+    std::unique_ptr<Scheduler> scheduler;
+    if ((cells.empty() || fork_at >= 0) && !(analyze_only && !tasks_file.empty())) {
+        scheduler = makeScheduler(scheduler_type, options);
+        if (!scheduler) {
+            std::cerr << "Unknown scheduler: " << scheduler_type << "\n";
+            return 1;
+        }
+    }
+
+    if (!tasks_file.empty()) {
+        ProcessNames names;
+        std::vector<PeriodicTask> tasks = loadPeriodicTasks(tasks_file, names);
+        if (tasks.empty()) {
+            std::cerr << "No tasks loaded.\n";
+            return 1;
+        }
+        Schedulability analysis = analyzeEDF(tasks);
+        if (analyze_only) {
+            ResultWriter out(STDOUT_FILENO);
+            printSchedulability(out, analysis);
+            return analysis.feasible ? 0 : 2;
+        }
+        if (!scheduler) {
+            std::cerr << "--tasks needs a single --scheduler\n";
+            return 1;
+        }
+        if (horizon <= 0) horizon = periodicHorizon(tasks);
+        if (horizon <= 0) {
+            std::cerr << "Hyperperiod overflows; pass --horizon\n";
+            return 1;
+        }
+        Gantt gantt;
+        if (!record_gantt) gantt.disable();
+        gantt.meterTo(charged);
+        RunMetrics metrics;
+        SimTime total_time = 0;
+        PeriodicFeed feed(tasks, horizon, metrics);
+        scheduler->run(feed, gantt, total_time);
+        std::unique_ptr<ResultWriter> out = openOutput(output_file);
+        if (!out) return 1;
+        if (format == OutputFormat::Text) printSchedulability(*out, analysis);
+        SegmentEncoder encoder(format, names);
+        printResults(*out, metrics, total_time, gantt, encoder, percentiles, charged);
+        return 0;
+    }
+
+    if (stream && scheduler) {
+        try {
+            if (random) {
+                WorkloadGenerator generator(workload);
+                GeneratedTraceReader reader(generator, num_random, random_from, threads);
+                return runStreaming(*scheduler, reader, output_file, format, record_gantt, percentiles, costs);
+            }
+            if (isBinaryTrace(input_file)) {
+                MappedTrace trace(input_file);
+                BinaryTraceReader reader(trace);
+                return runStreaming(*scheduler, reader, output_file, format, record_gantt, percentiles, costs);
+            }
+            std::ifstream file(input_file);
+            if (!file) {
+                std::cerr << "Error opening file: " << input_file << "\n";
+                return 1;
+            }
+            TextTraceReader reader(file);
+            return runStreaming(*scheduler, reader, output_file, format, record_gantt, percentiles, costs);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
 
     std::vector<Process> processes;
+    ProcessNames names;
 
     if (random) {
-        processes = generateRandomProcesses(num_random);
+        processes = generateRandomProcesses(workload, num_random, random_from, threads, names);
     } else if (!input_file.empty()) {
-        processes = loadProcesses(input_file);
+        processes = loadProcesses(input_file, names);
     } else {
         processes = {
-            {"P1", 0, 8, 2},
-            {"P2", 1, 4, 1},
-            {"P3", 2, 9, 3},
-            {"P4", 3, 5, 4}
+            {names.intern("P1"), 0, 8, 2},
+            {names.intern("P2"), 1, 4, 1},
+            {names.intern("P3"), 2, 9, 3},
+            {names.intern("P4"), 3, 5, 4}
         };
     }
 
@@ -359,37 +4971,83 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    std::unique_ptr<Scheduler> scheduler;
-    if (scheduler_type == "rr") {
-        scheduler = std::make_unique<RoundRobinScheduler>(quantum);
-    } else if (scheduler_type == "fcfs") {
-        scheduler = std::make_unique<FCFSScheduler>();
-    } else if (scheduler_type == "sjf") {
-        scheduler = std::make_unique<SJFScheduler>();
-    } else if (scheduler_type == "srtf") {
-        scheduler = std::make_unique<SRTFScheduler>();
-    } else if (scheduler_type == "priority") {
-        scheduler = std::make_unique<PriorityScheduler>();
-    } else {
-        std::cerr << "Unknown scheduler: " << scheduler_type << "\n";
-        return 1;
+    std::uint64_t fingerprint = workloadFingerprint(processes);
+    if (snapshot_at >= 0) {
+        if (snapshot_file.empty()) {
+            std::cerr << "--snapshot-at needs --snapshot-file\n";
+            return 1;
+        }
+        SimSnapshot snapshot = runPrefix(*scheduler, processes, arrivalOrder(processes), snapshot_at);
+        if (!snapshot.save(snapshot_file, fingerprint)) {
+            std::cerr << "Error: Could not write snapshot " << snapshot_file << "\n";
+            return 1;
+        }
+        std::cout << "Snapshot at " << snapshot.time << ": " << snapshot.live.size() << " live, "
+                  << snapshot.metrics.completed << " finished\n";
+        return 0;
     }
 
-    std::vector<std::pair<std::string, int>> gantt;
-    int total_time = 0;
-    scheduler->schedule(processes, gantt, total_time);
-    
-    if (!output_file.empty()) {
-        std::ofstream log(output_file);
-        if (log.is_open()) {
-            printResults(log, processes, total_time, gantt);
-            log.close();
+    std::unique_ptr<SimSnapshot> branch_point;
+    if (!restore_file.empty()) {
+        branch_point = std::make_unique<SimSnapshot>();
+        if (!branch_point->load(restore_file, processes)) {
+            std::cerr << "Error: " << restore_file << " is not a snapshot of this workload\n";
+            return 1;
+        }
+    } else if (fork_at >= 0) {
+        branch_point = std::make_unique<SimSnapshot>(runPrefix(*scheduler, processes, arrivalOrder(processes), fork_at));
+    }
+
+    if (!cells.empty()) {
+        runSweep(processes, cells, options, costs, threads, branch_point.get());
+        if (!output_file.empty()) {
+            std::ofstream log(output_file);
+            if (!log.is_open()) {
+                std::cerr << "Error: Could not open output file " << output_file << "\n";
+                return 1;
+            }
+            printSweep(log, cells, costs.enabled());
         } else {
-            std::cerr << "Error: Could not open output file " << output_file << "\n";
+            printSweep(std::cout, cells, costs.enabled());
         }
-    } else {
-        printResults(std::cout, processes, total_time, gantt);
+        return 0;
     }
 
-    return 0;
-}
\ No newline at end of file
+    if (cpus > 0) {
+        if (branch_point) {
+            std::cerr << "--cpus can't resume a snapshot\n";
+            return 1;
+        }
+        SMPPolicy policy;
+        if (!scheduler->smpPolicy(policy)) {
+            std::cerr << "Scheduler " << scheduler_type << " does not support --cpus\n";
+            return 1;
+        }
+        if (format != OutputFormat::Text) {
+            std::cerr << "--cpus only writes text results\n";
+            return 1;
+        }
+        SMPRun run;
+        SMPSimulator(policy, cpus, balance_interval, migration_cost, costs).run(processes, run);
+        std::unique_ptr<ResultWriter> out = openOutput(output_file);
+        if (!out) return 1;
+        printSMPResults(*out, processes, run, names, percentiles);
+        return 0;
+    }
+
+    Gantt gantt;
+    if (!record_gantt) gantt.disable();
+    gantt.meterTo(charged);
+    SimTime total_time = 0;
+    if (branch_point) {
+        RunMetrics metrics;
+        std::vector<int> order = arrivalOrder(processes);
+        BranchFeed feed(processes, order, *branch_point, std::numeric_limits<SimTime>::max(), gantt, metrics);
+        scheduler->run(feed, gantt, total_time);
+        return writeResults(output_file, format, metrics, total_time, gantt, names, percentiles, charged);
+    }
+    scheduler->schedule(processes, gantt, total_time);
+
+    return writeResults(output_file, format, collectMetrics(processes), total_time, gantt, names, percentiles, charged);
+}
+#endif